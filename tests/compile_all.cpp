@@ -0,0 +1,22 @@
+// Umbrella header with move-only ownership checks, every header alone is compiled from generated sources
+#include "vulgine.hpp"
+
+#include <type_traits>
+
+namespace {
+    template<typename T>
+    constexpr bool isMoveOnly = std::is_nothrow_move_constructible<T>::value && !std::is_copy_constructible<T>::value;
+
+    // Owners without explicitly deleted copy report copy constructible when they hold std::vector of handles
+    // (trait doesn't see element type), so they aren't listed
+    static_assert(isMoveOnly<vg::Instance>, "Instance must be move-only");
+    static_assert(isMoveOnly<vg::Device>, "Device must be move-only");
+    static_assert(isMoveOnly<vg::Swapchain>, "Swapchain must be move-only");
+    static_assert(isMoveOnly<vg::ComputePipeline>, "ComputePipeline must be move-only");
+    static_assert(isMoveOnly<vg::ComputeContext>, "ComputeContext must be move-only");
+    static_assert(isMoveOnly<vg::HiZ>, "HiZ must be move-only");
+    static_assert(isMoveOnly<vg::Texture>, "Texture must be move-only");
+    static_assert(isMoveOnly<vg::TextureStreamer>, "TextureStreamer must be move-only");
+    static_assert(isMoveOnly<vg::MappedFile>, "MappedFile must be move-only");
+    static_assert(isMoveOnly<vg::MeshFile>, "MeshFile must be move-only");
+}
@@ -0,0 +1,4 @@
+// GLFW has to be included before vulgine to enable window helpers
+#include <GLFW/glfw3.h>
+
+#include "vulgine.hpp"
@@ -0,0 +1,240 @@
+#include "vg_test.hpp"
+#include "vg_ecs.hpp"
+
+#include <algorithm>
+
+using namespace vg;
+
+struct Position {
+    float x, y, z;
+};
+
+struct Velocity {
+    float x, y, z;
+};
+
+static Transform translation(float x) {
+    Transform transform = {};
+    transform.model[0] = transform.model[5] = transform.model[10] = transform.model[15] = 1.0f;
+    transform.model[12] = x;
+
+    return transform;
+}
+
+static void testArchetypeMoves() {
+    World world;
+
+    Entity a = world.CreateEntity(Position{1, 2, 3});
+    Entity b = world.CreateEntity(Position{4, 5, 6}, Velocity{7, 8, 9});
+
+    VG_CHECK(world.getArchetypesCount() == 2);
+    VG_CHECK(world.HasComponent<Position>(a) && !world.HasComponent<Velocity>(a));
+
+    world.AddComponent(a, Velocity{-1, -2, -3});
+
+    VG_CHECK(world.HasComponent<Velocity>(a));
+    VG_CHECK(world.GetComponent<Position>(a)->x == 1 && world.GetComponent<Position>(a)->z == 3);
+    VG_CHECK(world.GetComponent<Velocity>(a)->y == -2);
+
+    // Adding existing component only sets its value
+    world.AddComponent(a, Velocity{10, 20, 30});
+    VG_CHECK(world.GetComponent<Velocity>(a)->x == 10);
+    VG_CHECK(world.getArchetypesCount() == 2);
+
+    world.RemoveComponent<Position>(b);
+
+    VG_CHECK(!world.HasComponent<Position>(b));
+    VG_CHECK(world.GetComponent<Position>(b) == nullptr);
+    VG_CHECK(world.GetComponent<Velocity>(b)->z == 9);
+    VG_CHECK(world.GetComponent<Velocity>(a)->z == 30);
+
+    uint32_t count = 0;
+    world.ForEach<const Position, const Velocity>([&](Entity entity, const Position& position, const Velocity& velocity) {
+        VG_CHECK(entity == a);
+        VG_CHECK(position.y == 2 && velocity.y == 20);
+        count++;
+    });
+    VG_CHECK(count == 1);
+}
+
+static void testDestroy() {
+    World world;
+
+    std::vector<Entity> entities;
+
+    for(uint32_t i = 0; i < 1000; i++) {
+        entities.push_back(world.CreateEntity(translation(i)));
+    }
+
+    // Swap-remove moves last rows into holes, others must keep their values
+    for(uint32_t i = 0; i < entities.size(); i += 3) {
+        world.DestroyEntity(entities[i]);
+    }
+
+    for(uint32_t i = 0; i < entities.size(); i++) {
+        VG_CHECK(world.IsAlive(entities[i]) == (i % 3 != 0));
+
+        if(i % 3 != 0) {
+            VG_CHECK(world.GetComponent<Transform>(entities[i])->model[12] == i);
+        }
+    }
+
+    VG_CHECK(world.getEntitiesCount() == 666);
+
+    // Freed index is reused with bumped generation, stale handle stays dead
+    Entity reused = world.CreateEntity(translation(-1));
+
+    VG_CHECK(reused.index % 3 == 0 && reused.index < entities.size());
+    VG_CHECK(reused.generation == entities[reused.index].generation + 1);
+    VG_CHECK(!world.IsAlive(entities[reused.index]));
+    VG_CHECK(world.GetComponent<Transform>(entities[reused.index]) == nullptr);
+
+    world.DestroyEntity(entities[reused.index]);
+    VG_CHECK(world.IsAlive(reused));
+}
+
+static void testChangedChunks() {
+    World world;
+
+    std::vector<Entity> entities;
+
+    for(uint32_t i = 0; i < 1000; i++) {
+        entities.push_back(world.CreateEntity(translation(i), Position{}));
+    }
+
+    uint32_t chunks = 0;
+    uint32_t rows = 0;
+    world.ForEachChangedChunk<Transform>(0, [&](const Entity*, const Transform*, uint32_t count) {
+        chunks++;
+        rows += count;
+    });
+
+    VG_CHECK(chunks > 1);
+    VG_CHECK(rows == entities.size());
+
+    uint64_t version = world.NextVersion();
+
+    world.ForEachChangedChunk<Transform>(version, [&](const Entity*, const Transform*, uint32_t) { VG_CHECK(false); });
+
+    world.SetComponent(entities[500], translation(5000));
+
+    chunks = 0;
+    world.ForEachChangedChunk<Transform>(version, [&](const Entity* chunkEntities, const Transform* transforms, uint32_t count) {
+        const Entity* entity = std::find(chunkEntities, chunkEntities + count, entities[500]);
+
+        VG_CHECK(entity != chunkEntities + count);
+        VG_CHECK(transforms[entity - chunkEntities].model[12] == 5000);
+        chunks++;
+    });
+    VG_CHECK(chunks == 1);
+
+    // Other columns of same chunk aren't marked
+    world.ForEachChangedChunk<Position>(version, [&](const Entity*, const Position*, uint32_t) { VG_CHECK(false); });
+
+    // Const access doesn't mark, mutable access marks every visited chunk
+    version = world.NextVersion();
+
+    world.ForEach<const Transform>([&](Entity, const Transform&) {});
+    world.ForEachChangedChunk<Transform>(version, [&](const Entity*, const Transform*, uint32_t) { VG_CHECK(false); });
+
+    world.ForEach<Position>([&](Entity, Position&) {});
+
+    rows = 0;
+    world.ForEachChangedChunk<Position>(version, [&](const Entity*, const Position*, uint32_t count) { rows += count; });
+    VG_CHECK(rows == entities.size());
+}
+
+static void testChangedAfterSwapRemove() {
+    World world;
+
+    std::vector<Entity> entities;
+
+    for(uint32_t i = 0; i < 1400; i++) {
+        entities.push_back(world.CreateEntity(Position{(float)i, 0, 0}));
+    }
+
+    std::vector<Entity> lastChunk;
+    uint32_t chunks = 0;
+    world.ForEachChangedChunk<Position>(0, [&](const Entity* chunkEntities, const Position*, uint32_t count) {
+        lastChunk.assign(chunkEntities, chunkEntities + count);
+        chunks++;
+    });
+    VG_CHECK(chunks == 2);
+
+    uint64_t version = world.NextVersion();
+
+    Entity last = lastChunk.back();
+    world.SetComponent(last, Position{42, 0, 0});
+
+    // Leave written entity alone in last chunk, then fill first chunk's hole with it
+    for(size_t i = 0; i + 1 < lastChunk.size(); i++) {
+        world.DestroyEntity(lastChunk[i]);
+    }
+
+    world.DestroyEntity(entities[0]);
+
+    VG_CHECK(world.IsAlive(last));
+    VG_CHECK(world.GetComponent<Position>(last)->x == 42);
+
+    uint32_t found = 0;
+    world.ForEachChangedChunk<Position>(version, [&](const Entity* chunkEntities, const Position* positions, uint32_t count) {
+        for(uint32_t i = 0; i < count; i++) {
+            if(chunkEntities[i] == last) {
+                VG_CHECK(positions[i].x == 42);
+                found++;
+            }
+        }
+    });
+    VG_CHECK(found == 1);
+}
+
+static void testRemovals() {
+    World world;
+
+    Entity a = world.CreateEntity(Position{}, Transform{});
+    Entity b = world.CreateEntity(Position{});
+    Entity c = world.CreateEntity(Transform{});
+
+    uint64_t version = world.NextVersion();
+
+    world.RemoveComponent<Position>(a);
+    world.DestroyEntity(b);
+    world.AddComponent(c, Position{});
+
+    std::vector<uint32_t> removed;
+    VG_CHECK(world.ForEachRemoved<Position>(version, [&](uint32_t index) { removed.push_back(index); }));
+    std::sort(removed.begin(), removed.end());
+    VG_CHECK((removed == std::vector<uint32_t>{a.index, b.index}));
+
+    removed.clear();
+    VG_CHECK(world.ForEachRemoved<Transform>(version, [&](uint32_t index) { removed.push_back(index); }));
+    VG_CHECK(removed.empty());
+
+    // Nothing removed after latest version
+    uint64_t latest = world.NextVersion();
+    VG_CHECK(world.ForEachRemoved<Position>(latest, [&](uint32_t) { VG_CHECK(false); }));
+
+    // History is kept for ecsRemovalHistory versions, then consumers have to rewrite everything
+    for(uint64_t i = 1; i < ecsRemovalHistory; i++) {
+        world.NextVersion();
+    }
+
+    removed.clear();
+    VG_CHECK(world.ForEachRemoved<Position>(version, [&](uint32_t index) { removed.push_back(index); }));
+    VG_CHECK(removed.size() == 2);
+
+    world.NextVersion();
+
+    VG_CHECK(!world.ForEachRemoved<Position>(version, [&](uint32_t) { VG_CHECK(false); }));
+    VG_CHECK(world.ForEachRemoved<Position>(latest, [&](uint32_t) { VG_CHECK(false); }));
+}
+
+int main() {
+    testArchetypeMoves();
+    testDestroy();
+    testChangedChunks();
+    testChangedAfterSwapRemove();
+    testRemovals();
+
+    return 0;
+}
@@ -0,0 +1,313 @@
+#include "vg_test.hpp"
+#include "vg_mesh.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <random>
+#include <set>
+
+using namespace vg;
+
+static std::string tempPath(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+static void grid(uint32_t size, std::vector<MeshVertex>& vertices, std::vector<uint32_t>& indices) {
+    for(uint32_t y = 0; y <= size; y++) {
+        for(uint32_t x = 0; x <= size; x++) {
+            vertices.push_back({{(float)x, (float)y, 0.0f}, {0.0f, 0.0f, 1.0f}, {(float)x / size, (float)y / size}});
+        }
+    }
+
+    for(uint32_t y = 0; y < size; y++) {
+        for(uint32_t x = 0; x < size; x++) {
+            uint32_t a = y * (size + 1) + x;
+
+            indices.insert(indices.end(), {a, a + 1, a + size + 1, a + 1, a + size + 2, a + size + 1});
+        }
+    }
+}
+
+static void testMeshlets() {
+    std::vector<MeshVertex> vertices;
+    std::vector<uint32_t> indices;
+    grid(32, vertices, indices);
+
+    MeshBuilder builder;
+    MeshData mesh = builder.Build(vertices, indices);
+
+    VG_CHECK(mesh.indexType == VK_INDEX_TYPE_UINT16);
+    VG_CHECK(mesh.indices.empty());
+    VG_CHECK(mesh.getIndexCount() == indices.size());
+    VG_CHECK(mesh.getIndexBytes() == indices.size() * sizeof(uint16_t));
+    VG_CHECK(mesh.vertices.size() == vertices.size());
+
+    // Meshlets respect limits and together contain every triangle of index buffer exactly once
+    std::multiset<std::array<uint32_t, 3>> expected;
+    std::multiset<std::array<uint32_t, 3>> found;
+
+    for(size_t t = 0; t < mesh.indices16.size(); t += 3) {
+        std::array<uint32_t, 3> triangle = {mesh.indices16[t], mesh.indices16[t + 1], mesh.indices16[t + 2]};
+        std::sort(triangle.begin(), triangle.end());
+
+        expected.insert(triangle);
+    }
+
+    for(const Meshlet& meshlet : mesh.meshlets) {
+        VG_CHECK(meshlet.vertexCount <= builder.maxMeshletVertices);
+        VG_CHECK(meshlet.triangleCount <= builder.maxMeshletTriangles);
+        VG_CHECK(meshlet.triangleOffset % 4 == 0);
+        VG_CHECK(meshlet.vertexOffset + meshlet.vertexCount <= mesh.meshletVertices.size());
+        VG_CHECK(meshlet.triangleOffset + meshlet.triangleCount * 3 <= mesh.meshletTriangles.size());
+        VG_CHECK(meshlet.radius > 0.0f);
+
+        for(uint32_t t = 0; t < meshlet.triangleCount; t++) {
+            std::array<uint32_t, 3> triangle;
+
+            for(uint32_t k = 0; k < 3; k++) {
+                uint8_t local = mesh.meshletTriangles[meshlet.triangleOffset + t * 3 + k];
+
+                VG_CHECK(local < meshlet.vertexCount);
+
+                triangle[k] = mesh.meshletVertices[meshlet.vertexOffset + local];
+            }
+
+            std::sort(triangle.begin(), triangle.end());
+            found.insert(triangle);
+        }
+    }
+
+    VG_CHECK(found == expected);
+
+    // Flat grid faces +z, so every meshlet cone points there
+    for(const Meshlet& meshlet : mesh.meshlets) {
+        VG_CHECK(meshlet.coneAxis[2] > 0.99f);
+    }
+}
+
+static void writeBytes(const std::string& path, const std::vector<char>& bytes) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(bytes.data(), bytes.size());
+}
+
+static void testRoundTrip(const MeshData& mesh, const std::string& name) {
+    std::string path = tempPath(name);
+
+    VG_CHECK(MeshBuilder::Write(mesh, path) == 0);
+
+    MeshFile file;
+    VG_CHECK(file.Open(path) == 0);
+
+    VG_CHECK(file.getVertexCount() == mesh.vertices.size());
+    VG_CHECK(memcmp(file.getVertices(), mesh.vertices.data(), mesh.vertices.size() * sizeof(QuantizedVertex)) == 0);
+
+    VG_CHECK(file.getIndexType() == mesh.indexType);
+    VG_CHECK(file.getIndexCount() == mesh.getIndexCount());
+    VG_CHECK(memcmp(file.getIndexData(), mesh.getIndexData(), mesh.getIndexBytes()) == 0);
+
+    VG_CHECK(file.getMeshletCount() == mesh.meshlets.size());
+    VG_CHECK(memcmp(file.getMeshlets(), mesh.meshlets.data(), mesh.meshlets.size() * sizeof(Meshlet)) == 0);
+    VG_CHECK(file.getMeshletVertexCount() == mesh.meshletVertices.size());
+    VG_CHECK(memcmp(file.getMeshletVertices(), mesh.meshletVertices.data(), mesh.meshletVertices.size() * sizeof(uint32_t)) == 0);
+    VG_CHECK(file.getMeshletTriangleBytes() == mesh.meshletTriangles.size());
+    VG_CHECK(memcmp(file.getMeshletTriangles(), mesh.meshletTriangles.data(), mesh.meshletTriangles.size()) == 0);
+}
+
+static void testCorruptFiles(const MeshData& mesh) {
+    std::string path = tempPath("vulgine_test_valid.vgm");
+    std::string corruptPath = tempPath("vulgine_test_corrupt.vgm");
+
+    VG_CHECK(MeshBuilder::Write(mesh, path) == 0);
+
+    const std::vector<char> valid = readFile(path);
+
+    auto openModified = [&](const std::function<void(std::vector<char>&, MeshFileHeader&)>& modify) {
+        std::vector<char> bytes = valid;
+        MeshFileHeader header;
+        memcpy(&header, bytes.data(), sizeof(header));
+
+        modify(bytes, header);
+
+        memcpy(bytes.data(), &header, sizeof(header));
+        writeBytes(corruptPath, bytes);
+
+        MeshFile file;
+
+        return file.Open(corruptPath);
+    };
+
+    VG_CHECK(openModified([](std::vector<char>&, MeshFileHeader&) {}) == 0);
+
+    // Last section cut off
+    VG_CHECK(openModified([](std::vector<char>& bytes, MeshFileHeader&) { bytes.resize(bytes.size() - 4); }) == 2);
+
+    // Offset so big that offset + size overflows
+    VG_CHECK(openModified([](std::vector<char>&, MeshFileHeader& header) { header.indicesOffset = UINT64_MAX - 15; }) == 2);
+
+    // Count bigger than section in file
+    VG_CHECK(openModified([](std::vector<char>&, MeshFileHeader& header) { header.vertexCount = UINT32_MAX; }) == 2);
+
+    VG_CHECK(openModified([](std::vector<char>&, MeshFileHeader& header) { header.indexCount -= 1; }) == 2);
+    VG_CHECK(openModified([](std::vector<char>&, MeshFileHeader& header) { header.indexType = 7; }) == 2);
+    VG_CHECK(openModified([](std::vector<char>&, MeshFileHeader& header) { header.version = meshFileVersion - 1; }) == 2);
+    VG_CHECK(openModified([](std::vector<char>&, MeshFileHeader& header) { header.verticesOffset += 1; }) == 2);
+
+    // Meshlet pointing past meshlet vertices
+    VG_CHECK(openModified([](std::vector<char>& bytes, MeshFileHeader& header) {
+        Meshlet meshlet;
+        memcpy(&meshlet, bytes.data() + header.meshletsOffset, sizeof(meshlet));
+
+        meshlet.vertexOffset = header.meshletVertexCount;
+
+        memcpy(bytes.data() + header.meshletsOffset, &meshlet, sizeof(meshlet));
+    }) == 2);
+
+    // Too small for header
+    writeBytes(corruptPath, std::vector<char>(valid.begin(), valid.begin() + 8));
+
+    MeshFile file;
+    VG_CHECK(file.Open(corruptPath) == 2);
+}
+
+// Average cache miss ratio (transformed vertices per triangle) of FIFO cache
+static float acmr(const std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize) {
+    std::vector<uint32_t> timestamps(vertexCount, 0);
+    uint32_t time = cacheSize + 1;
+    uint32_t misses = 0;
+
+    for(uint32_t v : indices) {
+        if(time - timestamps[v] > cacheSize) {
+            timestamps[v] = time++;
+            misses++;
+        }
+    }
+
+    return (float)misses / (indices.size() / 3);
+}
+
+static std::multiset<std::array<uint32_t, 3>> triangleSet(const std::vector<uint32_t>& indices) {
+    std::multiset<std::array<uint32_t, 3>> triangles;
+
+    for(size_t t = 0; t < indices.size(); t += 3) {
+        // Rotation keeps winding, so compare triangles starting at smallest index
+        std::array<uint32_t, 3> triangle = {indices[t], indices[t + 1], indices[t + 2]};
+        std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+
+        triangles.insert(triangle);
+    }
+
+    return triangles;
+}
+
+static void testVertexCache() {
+    std::vector<MeshVertex> vertices;
+    std::vector<uint32_t> indices;
+    grid(64, vertices, indices);
+
+    MeshBuilder builder;
+
+    // Row order grid, rows are longer than cache
+    std::vector<uint32_t> optimized = builder.OptimizeVertexCache(indices, vertices.size());
+
+    VG_CHECK(triangleSet(optimized) == triangleSet(indices));
+    VG_CHECK(acmr(optimized, vertices.size(), builder.cacheSize) <= acmr(indices, vertices.size(), builder.cacheSize));
+
+    // Shuffled triangles, fixed seed keeps test deterministic
+    std::vector<std::array<uint32_t, 3>> triangles(indices.size() / 3);
+    memcpy(triangles.data(), indices.data(), indices.size() * sizeof(uint32_t));
+
+    std::mt19937 random(1234);
+    std::shuffle(triangles.begin(), triangles.end(), random);
+
+    std::vector<uint32_t> shuffled(indices.size());
+    memcpy(shuffled.data(), triangles.data(), shuffled.size() * sizeof(uint32_t));
+
+    optimized = builder.OptimizeVertexCache(shuffled, vertices.size());
+
+    VG_CHECK(triangleSet(optimized) == triangleSet(shuffled));
+    VG_CHECK(acmr(optimized, vertices.size(), builder.cacheSize) <= acmr(shuffled, vertices.size(), builder.cacheSize));
+    VG_CHECK(acmr(optimized, vertices.size(), builder.cacheSize) < 1.0f);
+}
+
+static void testFloatToHalf() {
+    VG_CHECK(floatToHalf(0.0f) == 0x0000);
+    VG_CHECK(floatToHalf(-0.0f) == 0x8000);
+    VG_CHECK(floatToHalf(1.0f) == 0x3c00);
+    VG_CHECK(floatToHalf(-2.0f) == 0xc000);
+    VG_CHECK(floatToHalf(0.5f) == 0x3800);
+    VG_CHECK(floatToHalf(65504.0f) == 0x7bff);
+
+    // Smallest denormal and values rounding to zero
+    VG_CHECK(floatToHalf(std::ldexp(1.0f, -24)) == 0x0001);
+    VG_CHECK(floatToHalf(std::ldexp(1.0f, -30)) == 0x0000);
+
+    // Out of range values become infinity of same sign
+    VG_CHECK(floatToHalf(1.0e6f) == 0x7c00);
+    VG_CHECK(floatToHalf(-1.0e6f) == 0xfc00);
+    VG_CHECK(floatToHalf(std::numeric_limits<float>::infinity()) == 0x7c00);
+    VG_CHECK(floatToHalf(-std::numeric_limits<float>::infinity()) == 0xfc00);
+
+    uint16_t nan = floatToHalf(std::numeric_limits<float>::quiet_NaN());
+    VG_CHECK((nan & 0x7c00) == 0x7c00 && (nan & 0x3ff) != 0);
+}
+
+static void checkSameMesh(const MeshData& a, const MeshData& b) {
+    VG_CHECK(a.indexType == b.indexType);
+    VG_CHECK(a.indices == b.indices);
+    VG_CHECK(a.indices16 == b.indices16);
+    VG_CHECK(a.meshletVertices == b.meshletVertices);
+    VG_CHECK(a.meshletTriangles == b.meshletTriangles);
+
+    VG_CHECK(a.vertices.size() == b.vertices.size());
+    VG_CHECK(memcmp(a.vertices.data(), b.vertices.data(), a.vertices.size() * sizeof(QuantizedVertex)) == 0);
+    VG_CHECK(a.meshlets.size() == b.meshlets.size());
+    VG_CHECK(memcmp(a.meshlets.data(), b.meshlets.data(), a.meshlets.size() * sizeof(Meshlet)) == 0);
+}
+
+static void testBuildMany() {
+    std::vector<MeshSource> sources(7);
+
+    for(uint32_t i = 0; i < sources.size(); i++) {
+        grid(4 + i * 5, sources[i].vertices, sources[i].indices);
+    }
+
+    MeshBuilder builder;
+
+    std::vector<MeshData> meshes = builder.BuildMany(sources, 4);
+
+    VG_CHECK(meshes.size() == sources.size());
+
+    for(uint32_t i = 0; i < sources.size(); i++) {
+        checkSameMesh(meshes[i], builder.Build(sources[i].vertices, sources[i].indices));
+    }
+
+    VG_CHECK(builder.BuildMany({}, 4).empty());
+}
+
+int main() {
+    std::vector<MeshVertex> vertices;
+    std::vector<uint32_t> indices;
+    grid(16, vertices, indices);
+
+    MeshData mesh = MeshBuilder().Build(vertices, indices);
+
+    testMeshlets();
+    testVertexCache();
+    testFloatToHalf();
+    testBuildMany();
+    testRoundTrip(mesh, "vulgine_test_16.vgm");
+
+    // 32-bit indices without building mesh that big
+    MeshData wide = mesh;
+    wide.indices.assign(mesh.indices16.begin(), mesh.indices16.end());
+    wide.indices16.clear();
+    wide.indexType = VK_INDEX_TYPE_UINT32;
+
+    testRoundTrip(wide, "vulgine_test_32.vgm");
+    testCorruptFiles(mesh);
+
+    return 0;
+}
@@ -0,0 +1,110 @@
+#include "vg_test.hpp"
+#include "vg_submit.hpp"
+
+#include <thread>
+
+using namespace vg;
+
+static void testMpscQueue() {
+    const uint32_t producers = 4;
+    const uint32_t perProducer = 20000;
+
+    Vg_MpscQueue<uint32_t> queue;
+    std::vector<std::thread> threads;
+
+    for(uint32_t p = 0; p < producers; p++) {
+        threads.emplace_back([&queue, p]() {
+            for(uint32_t i = 0; i < perProducer; i++) {
+                queue.Push(p * perProducer + i);
+            }
+        });
+    }
+
+    // Consumer runs while producers push, every producer's elements must come in its order
+    std::vector<int64_t> lastSeen(producers, -1);
+    uint32_t received = 0;
+
+    while(received < producers * perProducer) {
+        uint32_t value;
+
+        if(!queue.Pop(value)) {
+            std::this_thread::yield();
+
+            continue;
+        }
+
+        uint32_t producer = value / perProducer;
+        int64_t index = value % perProducer;
+
+        VG_CHECK(producer < producers);
+        VG_CHECK(index == lastSeen[producer] + 1);
+
+        lastSeen[producer] = index;
+        received++;
+    }
+
+    for(auto& thread : threads) {
+        thread.join();
+    }
+
+    uint32_t value;
+    VG_CHECK(!queue.Pop(value));
+}
+
+static SubmitRequest request(VkQueue queue, std::vector<VkSemaphore> waits, std::vector<VkSemaphore> signals) {
+    SubmitRequest submit;
+    submit.queue = queue;
+    submit.waitSemaphores = waits;
+    submit.signalSemaphores = signals;
+
+    return submit;
+}
+
+static void testSortRequests() {
+    VkQueue graphics = testHandle<VkQueue>(1);
+    VkQueue compute = testHandle<VkQueue>(2);
+
+    VkSemaphore first = testHandle<VkSemaphore>(10);
+    VkSemaphore second = testHandle<VkSemaphore>(11);
+
+    // Arrived in reverse of dependency order, independent graphics request arrived last
+    std::vector<SubmitRequest> requests = {
+        request(graphics, {second}, {}),
+        request(compute, {first}, {second}),
+        request(graphics, {}, {first}),
+        request(graphics, {}, {})
+    };
+
+    std::vector<uint32_t> order;
+    SubmitBatcher::SortRequests(requests, order);
+
+    // Signal comes before wait, independent request joins run on same queue
+    std::vector<uint32_t> expected = {2, 3, 1, 0};
+    VG_CHECK(order == expected);
+
+    // Without dependencies ready requests on queue of previous one go first, so arrival order is kept only within a queue
+    requests = {request(compute, {}, {}), request(graphics, {}, {}), request(compute, {}, {})};
+    SubmitBatcher::SortRequests(requests, order);
+
+    expected = {0, 2, 1};
+    VG_CHECK(order == expected);
+
+    // Wait on semaphore signaled outside of batch doesn't block
+    requests = {request(graphics, {testHandle<VkSemaphore>(99)}, {})};
+    SubmitBatcher::SortRequests(requests, order);
+
+    VG_CHECK(order.size() == 1 && order[0] == 0);
+
+    // Cycle is reported, but every request still gets submitted
+    requests = {request(graphics, {first}, {second}), request(compute, {second}, {first})};
+    SubmitBatcher::SortRequests(requests, order);
+
+    VG_CHECK(order.size() == 2);
+}
+
+int main() {
+    testMpscQueue();
+    testSortRequests();
+
+    return 0;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <iostream>
+#include <cstdlib>
+#include <cstdint>
+
+// Unlike assert it stays in release builds
+#define VG_CHECK(condition) \
+    do { \
+        if(!(condition)) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " << #condition << "\n"; \
+            std::exit(1); \
+        } \
+    } while(0)
+
+namespace vg {
+    /**
+     * @brief Fake Vulkan handle for tests that only compare handles, never pass them to Vulkan
+     * 
+     * @param value non-zero id
+     * @return T
+     */
+    template<typename T>
+    T testHandle(uintptr_t value) { return (T)value; }
+}
@@ -0,0 +1,353 @@
+#pragma once
+#define VG_COMPUTE 1
+
+#ifndef VG_DEVICES
+#include "vg_devices.hpp"
+#endif
+
+#ifndef VG_FILE
+#include "vg_file.hpp"
+#endif
+
+#ifndef VG_SUBMIT
+#include "vg_submit.hpp"
+#endif
+
+#include <vector>
+#include <string>
+
+namespace vg {
+    class Vg_ComputePipeline {
+    private:
+        PipelineLayoutHandle pipelineLayout;
+        PipelineHandle pipeline;
+
+        Device* pDevice = nullptr;
+
+        VkShaderModule createShaderModule(const std::vector<char>& code) {
+            VkShaderModuleCreateInfo moduleInfo{VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO};
+            moduleInfo.codeSize = code.size();
+            moduleInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+
+            VkShaderModule shaderModule;
+
+            if(vkCreateShaderModule(*pDevice->getLogicalDevicePtr(), &moduleInfo, nullptr, &shaderModule) != VK_SUCCESS) {
+                std::cerr << "Cannot create shader module!\n";
+
+                VG_PROFILE_EXIT(18);
+                exit(18);
+            }
+
+            return shaderModule;
+        }
+
+    public:
+        /**
+         * @brief Create a Compute Pipeline from SPIR-V file
+         * 
+         * @param _pDevice pointer to created Device
+         * @param shaderPath path to compiled compute shader (.spv), entry point is "main"
+         * @param setLayouts descriptor set layouts used by shader
+         * @param pushConstantsSize size of push constants block in bytes (0 when shader has none)
+         */
+        void CreateComputePipeline(Device* _pDevice, const std::string& shaderPath, const std::vector<VkDescriptorSetLayout>& setLayouts, uint32_t pushConstantsSize = 0) {
+            pDevice = _pDevice;
+
+            VkDevice device = *pDevice->getLogicalDevicePtr();
+
+            // Only needed until pipeline is created
+            ShaderModuleHandle shaderModule(createShaderModule(readFile(shaderPath)), {device});
+
+            VkPushConstantRange pushConstantRange{};
+            pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+            pushConstantRange.offset = 0;
+            pushConstantRange.size = pushConstantsSize;
+
+            VkPipelineLayoutCreateInfo layoutInfo{VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
+            layoutInfo.setLayoutCount = setLayouts.size();
+            layoutInfo.pSetLayouts = setLayouts.data();
+            layoutInfo.pushConstantRangeCount = pushConstantsSize > 0 ? 1 : 0;
+            layoutInfo.pPushConstantRanges = &pushConstantRange;
+
+            if(vkCreatePipelineLayout(device, &layoutInfo, nullptr, pipelineLayout.put({device})) != VK_SUCCESS) {
+                std::cerr << "Cannot create compute pipeline layout!\n";
+
+                VG_PROFILE_EXIT(19);
+                exit(19);
+            }
+
+            VkPipelineShaderStageCreateInfo stageInfo{VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO};
+            stageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+            stageInfo.module = shaderModule.get();
+            stageInfo.pName = "main";
+
+            VkComputePipelineCreateInfo pipelineInfo{VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO};
+            pipelineInfo.stage = stageInfo;
+            pipelineInfo.layout = pipelineLayout.get();
+
+            if(vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, pipeline.put({device})) != VK_SUCCESS) {
+                std::cerr << "Cannot create compute pipeline!\n";
+
+                VG_PROFILE_EXIT(20);
+                exit(20);
+            }
+        }
+
+        /**
+         * @brief Bind pipeline to command buffer
+         * 
+         * @param commandBuffer
+         */
+        void Bind(VkCommandBuffer commandBuffer) {
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.get());
+        }
+
+        /**
+         * @brief Bind descriptor sets starting at set 0
+         * 
+         * @param commandBuffer 
+         * @param descriptorSets 
+         */
+        void BindDescriptorSets(VkCommandBuffer commandBuffer, const std::vector<VkDescriptorSet>& descriptorSets) {
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout.get(), 0, descriptorSets.size(), descriptorSets.data(), 0, nullptr);
+        }
+
+        /**
+         * @brief Update push constants block
+         * 
+         * @param commandBuffer 
+         * @param data 
+         * @param size in bytes, not bigger than pushConstantsSize from creation
+         */
+        void PushConstants(VkCommandBuffer commandBuffer, const void* data, uint32_t size) {
+            vkCmdPushConstants(commandBuffer, pipelineLayout.get(), VK_SHADER_STAGE_COMPUTE_BIT, 0, size, data);
+        }
+
+        /**
+         * @brief Dispatch enough workgroups to cover given invocations count
+         * 
+         * @param commandBuffer 
+         * @param width invocations in x
+         * @param height invocations in y
+         * @param depth invocations in z
+         * @param localSizeX local_size_x of shader
+         * @param localSizeY local_size_y of shader
+         * @param localSizeZ local_size_z of shader
+         */
+        void Dispatch(VkCommandBuffer commandBuffer, uint32_t width, uint32_t height = 1, uint32_t depth = 1, uint32_t localSizeX = 64, uint32_t localSizeY = 1, uint32_t localSizeZ = 1) {
+            vkCmdDispatch(commandBuffer, groupCount(width, localSizeX), groupCount(height, localSizeY), groupCount(depth, localSizeZ));
+        }
+
+        /**
+         * @brief Dispatch with workgroups count read from buffer (VkDispatchIndirectCommand)
+         * 
+         * @param commandBuffer 
+         * @param buffer 
+         * @param offset 
+         */
+        void DispatchIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset = 0) {
+            vkCmdDispatchIndirect(commandBuffer, buffer, offset);
+        }
+
+        /**
+         * @brief Workgroups needed to cover size invocations
+         * 
+         * @param size 
+         * @param localSize 
+         * @return uint32_t 
+         */
+        static uint32_t groupCount(uint32_t size, uint32_t localSize) {
+            return (size + localSize - 1) / localSize;
+        }
+
+        /**
+         * @brief Get the Pipeline Ptr
+         * 
+         * @return const VkPipeline*
+         */
+        const VkPipeline* getPipelinePtr() { return pipeline.getPtr(); }
+
+        /**
+         * @brief Get the Pipeline Layout Ptr
+         * 
+         * @return const VkPipelineLayout*
+         */
+        const VkPipelineLayout* getPipelineLayoutPtr() { return pipelineLayout.getPtr(); }
+    };
+
+    typedef Vg_ComputePipeline ComputePipeline;
+
+    /**
+     * @brief Command buffers and semaphores for work on Device compute queue
+     * 
+     * Each frame records into its own command buffer and signals its own semaphore,
+     * graphics submit of same frame waits on it, so compute of next frame can overlap graphics of current one.
+     * Command buffer of frame is reused after fence of graphics submit that waited on it was signaled.
+     */
+    class Vg_ComputeContext {
+    private:
+        CommandPoolHandle commandPool;
+        std::vector<VkCommandBuffer> commandBuffers;
+        std::vector<SemaphoreHandle> finishedSemaphores;
+
+        Device* pDevice = nullptr;
+
+        uint32_t computeFamily = 0;
+        uint32_t graphicsFamily = 0;
+
+    public:
+        /**
+         * @brief Create Compute Context
+         * 
+         * @param _pDevice pointer to created Device
+         * @param framesInFlight 
+         */
+        void CreateComputeContext(Device* _pDevice, uint32_t framesInFlight) {
+            pDevice = _pDevice;
+
+            VkDevice device = *pDevice->getLogicalDevicePtr();
+
+            const QueueFamilyIndices& indices = pDevice->getQueueFamilies();
+            computeFamily = indices.computeFamily.value();
+            graphicsFamily = indices.graphicsFamily.value();
+
+            VkCommandPoolCreateInfo poolInfo{VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+            poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+            poolInfo.queueFamilyIndex = computeFamily;
+
+            if(vkCreateCommandPool(device, &poolInfo, nullptr, commandPool.put({device})) != VK_SUCCESS) {
+                std::cerr << "Cannot create compute command pool!\n";
+
+                VG_PROFILE_EXIT(25);
+                exit(25);
+            }
+
+            commandBuffers.resize(framesInFlight);
+
+            VkCommandBufferAllocateInfo allocInfo{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+            allocInfo.commandPool = commandPool.get();
+            allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            allocInfo.commandBufferCount = framesInFlight;
+
+            if(vkAllocateCommandBuffers(device, &allocInfo, commandBuffers.data()) != VK_SUCCESS) {
+                std::cerr << "Cannot allocate compute command buffers!\n";
+
+                VG_PROFILE_EXIT(26);
+                exit(26);
+            }
+
+            finishedSemaphores.clear();
+            finishedSemaphores.resize(framesInFlight);
+
+            VkSemaphoreCreateInfo semaphoreInfo{VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+
+            for(uint32_t i = 0; i < framesInFlight; i++) {
+                if(vkCreateSemaphore(device, &semaphoreInfo, nullptr, finishedSemaphores[i].put({device})) != VK_SUCCESS) {
+                    std::cerr << "Cannot create compute semaphore!\n";
+
+                    VG_PROFILE_EXIT(27);
+                    exit(27);
+                }
+            }
+        }
+
+        /**
+         * @brief Reset and begin command buffer of frame
+         * 
+         * @param frameIndex 
+         * @return VkCommandBuffer 
+         */
+        VkCommandBuffer Begin(uint32_t frameIndex) {
+            VkCommandBuffer commandBuffer = commandBuffers[frameIndex];
+
+            vkResetCommandBuffer(commandBuffer, 0);
+
+            VkCommandBufferBeginInfo beginInfo{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+            vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+            return commandBuffer;
+        }
+
+        /**
+         * @brief End command buffer of frame and queue it on compute queue, signals getFinishedSemaphore(frameIndex)
+         * 
+         * @param submitBatcher 
+         * @param frameIndex 
+         * @param waitSemaphores semaphores compute work waits on (eg. graphics work producing its input)
+         * @param waitStages stages of waits, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT when empty
+         */
+        void Submit(SubmitBatcher* submitBatcher, uint32_t frameIndex, const std::vector<VkSemaphore>& waitSemaphores = {}, const std::vector<VkPipelineStageFlags>& waitStages = {}) {
+            vkEndCommandBuffer(commandBuffers[frameIndex]);
+
+            SubmitRequest request;
+            request.queue = *pDevice->getComputeQueuePtr();
+            request.commandBuffers = {commandBuffers[frameIndex]};
+            request.waitSemaphores = waitSemaphores;
+            request.waitStages = waitStages;
+            request.waitStages.resize(waitSemaphores.size(), VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+            request.signalSemaphores = {finishedSemaphores[frameIndex].get()};
+
+            submitBatcher->Submit(std::move(request));
+        }
+
+        /**
+         * @brief Record queue family ownership transfer of buffer between compute and graphics queue,
+         * record with release = true on source queue and release = false on destination queue.
+         * Only barrier is recorded when both queues are from same family.
+         * 
+         * @param commandBuffer 
+         * @param buffer 
+         * @param toGraphics transfer direction, compute -> graphics when true
+         * @param release 
+         * @param stageMask source stage on release, destination stage on acquire
+         * @param accessMask source access on release, destination access on acquire
+         */
+        void TransferBuffer(VkCommandBuffer commandBuffer, VkBuffer buffer, bool toGraphics, bool release, VkPipelineStageFlags stageMask, VkAccessFlags accessMask) {
+            bool sameFamily = computeFamily == graphicsFamily;
+
+            if(sameFamily && !release) {
+                return;
+            }
+
+            VkBufferMemoryBarrier barrier{VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER};
+            barrier.srcQueueFamilyIndex = sameFamily ? VK_QUEUE_FAMILY_IGNORED : (toGraphics ? computeFamily : graphicsFamily);
+            barrier.dstQueueFamilyIndex = sameFamily ? VK_QUEUE_FAMILY_IGNORED : (toGraphics ? graphicsFamily : computeFamily);
+            barrier.buffer = buffer;
+            barrier.offset = 0;
+            barrier.size = VK_WHOLE_SIZE;
+            barrier.srcAccessMask = release ? accessMask : 0;
+            barrier.dstAccessMask = release ? 0 : accessMask;
+
+            VkPipelineStageFlags srcStage = release ? stageMask : (VkPipelineStageFlags)VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+            VkPipelineStageFlags dstStage = release ? (VkPipelineStageFlags)VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : stageMask;
+
+            if(sameFamily) {
+                // single queue: plain execution and memory dependency to everything after
+                barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+                dstStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+            }
+
+            vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+        }
+
+        /**
+         * @brief Get semaphore signaled when compute work of frame finishes, wait on it in graphics submit
+         * 
+         * @param frameIndex 
+         * @return VkSemaphore 
+         */
+        VkSemaphore getFinishedSemaphore(uint32_t frameIndex) { return finishedSemaphores[frameIndex].get(); }
+
+        /**
+         * @brief Get the Command Buffer of frame
+         * 
+         * @param frameIndex 
+         * @return VkCommandBuffer 
+         */
+        VkCommandBuffer getCommandBuffer(uint32_t frameIndex) { return commandBuffers[frameIndex]; }
+    };
+
+    typedef Vg_ComputeContext ComputeContext;
+}
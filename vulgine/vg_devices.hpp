@@ -3,8 +3,10 @@
 
 #include <vulkan/vulkan.hpp>
 #include <optional>
+#include <cstring>
 #include <iostream>
 #include <set>
+#include <algorithm>
 
 #ifndef VG_INSTANCE 
 #include "vg_instance.hpp"
@@ -15,9 +17,15 @@ namespace vg {
         VK_KHR_SWAPCHAIN_EXTENSION_NAME
     };
 
+    const std::vector<const char*> presentWaitExtensions = {
+        VK_KHR_PRESENT_ID_EXTENSION_NAME,
+        VK_KHR_PRESENT_WAIT_EXTENSION_NAME
+    };
+
     struct QueueFamilyIndices {
         std::optional<uint32_t> graphicsFamily;
         std::optional<uint32_t> presentFamily;
+        std::optional<uint32_t> computeFamily;
 
         bool isComplete() {
             return graphicsFamily.has_value() && presentFamily.has_value();
@@ -33,13 +41,42 @@ namespace vg {
     class Vg_Device {
     private:
         VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
-        VkDevice logicalDevice;
+        DeviceHandle logicalDevice;
 
         VkQueue presentQueue;
         VkQueue graphicsQueue;
+        VkQueue computeQueue;
+
+        // Found once in CreateDevices, queue families of a device don't change
+        QueueFamilyIndices queueFamilies;
+        bool asyncCompute = false;
 
+        // Not owned, Instance has to outlive Device
         Instance* _pInstance;
 
+        std::vector<const char*> enabledExtensions;
+        bool presentWaitEnabled = false;
+        bool drawIndirectCountEnabled = false;
+        bool multiDrawIndirectEnabled = false;
+        bool storageImageExtendedFormatsEnabled = false;
+        bool synchronization2Enabled = false;
+
+        bool isExtensionAvailable(const char* extensionName) {
+            uint32_t count = 0;
+            vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &count, nullptr);
+
+            std::vector<VkExtensionProperties> extProp(count);
+            vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &count, extProp.data());
+
+            for(const auto& e : extProp) {
+                if(strcmp(e.extensionName, extensionName) == 0) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
         bool checkDeviceExtensionSupport() {
             uint32_t count = 0;
             vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &count, nullptr);
@@ -69,7 +106,7 @@ namespace vg {
             for(const auto& fam : familyProp) {
                 VkBool32 presentSupported = false;
 
-                vkGetPhysicalDeviceSurfaceSupportKHR(_pd_, i, _pInstance->presentSurface, &presentSupported);
+                vkGetPhysicalDeviceSurfaceSupportKHR(_pd_, i, _pInstance->getPresentSurface(), &presentSupported);
 
                 if(fam.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
                     indices.graphicsFamily = i;
@@ -86,7 +123,7 @@ namespace vg {
                 i++;
             }
 
-            uint32_t count = 0;
+            count = 0;
             vkEnumerateDeviceExtensionProperties(_pd_, nullptr, &count, nullptr);
 
             std::vector<VkExtensionProperties> extProp(count);
@@ -105,23 +142,23 @@ namespace vg {
             if(extensionSupported) {
                 SwapchainSupportDetails details;
 
-                vkGetPhysicalDeviceSurfaceCapabilitiesKHR(_pd_, _pInstance->presentSurface, &details.capabilities);
+                vkGetPhysicalDeviceSurfaceCapabilitiesKHR(_pd_, _pInstance->getPresentSurface(), &details.capabilities);
 
                 uint32_t count = 0;
-                vkGetPhysicalDeviceSurfaceFormatsKHR(_pd_, _pInstance->presentSurface, &count, nullptr);
+                vkGetPhysicalDeviceSurfaceFormatsKHR(_pd_, _pInstance->getPresentSurface(), &count, nullptr);
 
                 if(count != 0) {
                     details.formats.resize(count);
 
-                    vkGetPhysicalDeviceSurfaceFormatsKHR(_pd_, _pInstance->presentSurface, &count, details.formats.data());
+                    vkGetPhysicalDeviceSurfaceFormatsKHR(_pd_, _pInstance->getPresentSurface(), &count, details.formats.data());
                 }
 
-                vkGetPhysicalDeviceSurfacePresentModesKHR(_pd_, _pInstance->presentSurface, &count, nullptr);
+                vkGetPhysicalDeviceSurfacePresentModesKHR(_pd_, _pInstance->getPresentSurface(), &count, nullptr);
 
                 if(count != 0) {
                     details.presentModes.resize(count);
 
-                    vkGetPhysicalDeviceSurfacePresentModesKHR(_pd_, _pInstance->presentSurface, &count, details.presentModes.data());
+                    vkGetPhysicalDeviceSurfacePresentModesKHR(_pd_, _pInstance->getPresentSurface(), &count, details.presentModes.data());
                 }
 
                 swapchainAdequate = !details.formats.empty() && !details.presentModes.empty();
@@ -141,6 +178,8 @@ namespace vg {
          * @return int should return 0
          */
         int CreateDevices(Instance* pInstance) {
+            VG_PROFILE_FUNCTION();
+
             _pInstance = pInstance;
 
             uint32_t count = 0;
@@ -160,13 +199,14 @@ namespace vg {
             if(physicalDevice == VK_NULL_HANDLE) {
                 std::cerr << "Cannot find proper physical device!\n";
 
+                VG_PROFILE_EXIT(5);
                 exit(5);
             }
 
             QueueFamilyIndices indices = findQueueFamily();
 
             std::vector<VkDeviceQueueCreateInfo> queueInfos;
-            std::set<uint32_t> uniqueQueueFamilies = {indices.graphicsFamily.value(), indices.presentFamily.value()};
+            std::set<uint32_t> uniqueQueueFamilies = {indices.graphicsFamily.value(), indices.presentFamily.value(), indices.computeFamily.value()};
 
             float queuePriority = 1.0f;
 
@@ -179,15 +219,107 @@ namespace vg {
                 queueInfos.push_back(info);
             }
 
+            VkPhysicalDeviceFeatures supportedFeatures;
+            vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+
             VkPhysicalDeviceFeatures deviceFeatures{};
             deviceFeatures.samplerAnisotropy = VK_TRUE;
+            deviceFeatures.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+            // Needed for rg32f storage images of Vg_HiZ depth pyramid
+            deviceFeatures.shaderStorageImageExtendedFormats = supportedFeatures.shaderStorageImageExtendedFormats;
+
+            multiDrawIndirectEnabled = supportedFeatures.multiDrawIndirect;
+            storageImageExtendedFormatsEnabled = supportedFeatures.shaderStorageImageExtendedFormats;
+
+            enabledExtensions = deviceExtensions;
+
+            void* featuresChain = nullptr;
+
+            VkPhysicalDeviceProperties deviceProperties;
+            vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+
+            // Device can only use functionality of version that both instance requested and device supports
+            uint32_t apiVersion = std::min(_pInstance->getApiVersion(), deviceProperties.apiVersion);
+
+            // drawIndirectCount is core since Vulkan 1.2 and VK_KHR_draw_indirect_count before,
+            // without both Vg_DrawBatcher falls back to vkCmdDrawIndexedIndirect
+            VkPhysicalDeviceVulkan12Features vulkan12Features{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES};
+
+            drawIndirectCountEnabled = false;
+
+            if(apiVersion >= VK_API_VERSION_1_2) {
+                VkPhysicalDeviceFeatures2 features2{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2};
+                features2.pNext = &vulkan12Features;
+
+                vkGetPhysicalDeviceFeatures2(physicalDevice, &features2);
+
+                drawIndirectCountEnabled = vulkan12Features.drawIndirectCount;
+
+                VkPhysicalDeviceVulkan12Features requested{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES};
+                requested.drawIndirectCount = vulkan12Features.drawIndirectCount;
+
+                vulkan12Features = requested;
+                vulkan12Features.pNext = featuresChain;
+                featuresChain = &vulkan12Features;
+            }
+            else if(isExtensionAvailable(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME)) {
+                enabledExtensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+
+                drawIndirectCountEnabled = true;
+            }
+
+            // present_id/present_wait are optional, they only enable frame pacing in Vg_Swapchain
+            VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR};
+            VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR};
+            presentIdFeatures.pNext = &presentWaitFeatures;
+
+            presentWaitEnabled = false;
+
+            // Feature queries below need vkGetPhysicalDeviceFeatures2 (Vulkan 1.1)
+            if(apiVersion >= VK_API_VERSION_1_1 && isExtensionAvailable(VK_KHR_PRESENT_ID_EXTENSION_NAME) && isExtensionAvailable(VK_KHR_PRESENT_WAIT_EXTENSION_NAME)) {
+                VkPhysicalDeviceFeatures2 features2{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2};
+                features2.pNext = &presentIdFeatures;
+
+                vkGetPhysicalDeviceFeatures2(physicalDevice, &features2);
+
+                presentWaitEnabled = presentIdFeatures.presentId && presentWaitFeatures.presentWait;
+            }
+
+            if(presentWaitEnabled) {
+                enabledExtensions.insert(enabledExtensions.end(), presentWaitExtensions.begin(), presentWaitExtensions.end());
+
+                presentWaitFeatures.pNext = featuresChain;
+                featuresChain = &presentIdFeatures;
+            }
+
+            // vkQueueSubmit2 lets Vg_SubmitBatcher pass all batches of queue in one call, without it vkQueueSubmit is used
+            VkPhysicalDeviceSynchronization2FeaturesKHR synchronization2Features{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR};
+
+            synchronization2Enabled = false;
+
+            if(apiVersion >= VK_API_VERSION_1_1 && isExtensionAvailable(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME)) {
+                VkPhysicalDeviceFeatures2 features2{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2};
+                features2.pNext = &synchronization2Features;
+
+                vkGetPhysicalDeviceFeatures2(physicalDevice, &features2);
+
+                synchronization2Enabled = synchronization2Features.synchronization2;
+            }
+
+            if(synchronization2Enabled) {
+                enabledExtensions.push_back(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+
+                synchronization2Features.pNext = featuresChain;
+                featuresChain = &synchronization2Features;
+            }
 
             VkDeviceCreateInfo deviceInfo{VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO};
+            deviceInfo.pNext = featuresChain;
             deviceInfo.queueCreateInfoCount = queueInfos.size();
             deviceInfo.pQueueCreateInfos = queueInfos.data();
             deviceInfo.pEnabledFeatures = &deviceFeatures;
-            deviceInfo.enabledExtensionCount = deviceExtensions.size();
-            deviceInfo.ppEnabledExtensionNames = deviceExtensions.data();
+            deviceInfo.enabledExtensionCount = enabledExtensions.size();
+            deviceInfo.ppEnabledExtensionNames = enabledExtensions.data();
 
             if(enableValidationLayers) {
                 deviceInfo.enabledLayerCount = validationLayers.size();
@@ -197,18 +329,26 @@ namespace vg {
                 deviceInfo.enabledLayerCount = 0;
             }
 
-            if(vkCreateDevice(physicalDevice, &deviceInfo, nullptr, &logicalDevice) != VK_SUCCESS) {
+            if(vkCreateDevice(physicalDevice, &deviceInfo, nullptr, logicalDevice.put()) != VK_SUCCESS) {
                 std::cerr << "Cannot create logical device!\n";
 
+                VG_PROFILE_EXIT(6);
                 exit(6);
             }
 
-            vkGetDeviceQueue(logicalDevice, indices.graphicsFamily.value(), 0, &graphicsQueue);
-            vkGetDeviceQueue(logicalDevice, indices.presentFamily.value(), 0, &presentQueue);
+            vkGetDeviceQueue(logicalDevice.get(), indices.graphicsFamily.value(), 0, &graphicsQueue);
+            vkGetDeviceQueue(logicalDevice.get(), indices.presentFamily.value(), 0, &presentQueue);
+            vkGetDeviceQueue(logicalDevice.get(), indices.computeFamily.value(), 0, &computeQueue);
+
+            queueFamilies = indices;
+            asyncCompute = indices.computeFamily.value() != indices.graphicsFamily.value();
+
+            return 0;
         }
 
         /**
-         * @brief Find queue families support eg. graphics nd present support
+         * @brief Find queue families support eg. graphics nd present support,
+         * compute family is compute-only one when device has it (async compute), else graphics family
          * 
          * @return QueueFamilyIndices 
          */
@@ -225,7 +365,7 @@ namespace vg {
             for(const auto& fam : familyProp) {
                 VkBool32 presentSupported = false;
 
-                vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, _pInstance->presentSurface, &presentSupported);
+                vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, _pInstance->getPresentSurface(), &presentSupported);
 
                 if(fam.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
                     indices.graphicsFamily = i;
@@ -242,6 +382,18 @@ namespace vg {
                 i++;
             }
 
+            for(uint32_t j = 0; j < count; j++) {
+                if((familyProp[j].queueFlags & VK_QUEUE_COMPUTE_BIT) && !(familyProp[j].queueFlags & VK_QUEUE_GRAPHICS_BIT)) {
+                    indices.computeFamily = j;
+
+                    break;
+                }
+            }
+
+            if(!indices.computeFamily.has_value()) {
+                indices.computeFamily = indices.graphicsFamily;
+            }
+
             return indices;
         }
 
@@ -253,28 +405,229 @@ namespace vg {
         SwapchainSupportDetails querySwapchainSupport() {
             SwapchainSupportDetails details;
 
-            vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physicalDevice, _pInstance->presentSurface, &details.capabilities);
+            vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physicalDevice, _pInstance->getPresentSurface(), &details.capabilities);
 
             uint32_t count = 0;
-            vkGetPhysicalDeviceSurfaceFormatsKHR(physicalDevice, _pInstance->presentSurface, &count, nullptr);
+            vkGetPhysicalDeviceSurfaceFormatsKHR(physicalDevice, _pInstance->getPresentSurface(), &count, nullptr);
 
             if(count != 0) {
                 details.formats.resize(count);
 
-                vkGetPhysicalDeviceSurfaceFormatsKHR(physicalDevice, _pInstance->presentSurface, &count, details.formats.data());
+                vkGetPhysicalDeviceSurfaceFormatsKHR(physicalDevice, _pInstance->getPresentSurface(), &count, details.formats.data());
             }
 
-            vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, _pInstance->presentSurface, &count, nullptr);
+            vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, _pInstance->getPresentSurface(), &count, nullptr);
 
             if(count != 0) {
                 details.presentModes.resize(count);
 
-                vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, _pInstance->presentSurface, &count, details.presentModes.data());
+                vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, _pInstance->getPresentSurface(), &count, details.presentModes.data());
             }
 
             return details;
         }
 
+        /**
+         * @brief Find memory type index that matches type filter and has all properties
+         * 
+         * @param typeFilter memoryTypeBits from VkMemoryRequirements
+         * @param properties required memory properties
+         * @return uint32_t 
+         */
+        uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) {
+            VkPhysicalDeviceMemoryProperties memProp;
+            vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProp);
+
+            for(uint32_t i = 0; i < memProp.memoryTypeCount; i++) {
+                if((typeFilter & (1 << i)) && (memProp.memoryTypes[i].propertyFlags & properties) == properties) {
+                    return i;
+                }
+            }
+
+            std::cerr << "Cannot find suitable memory type!\n";
+
+            VG_PROFILE_EXIT(12);
+            exit(12);
+        }
+
+        /**
+         * @brief Create buffer and allocate and bind memory for it
+         * 
+         * @param size size of buffer in bytes
+         * @param usage buffer usage
+         * @param properties memory properties eg. VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+         * @param buffer created buffer
+         * @param memory allocated memory
+         */
+        void CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& memory) {
+            VG_PROFILE_FUNCTION();
+
+            VkBufferCreateInfo bufferInfo{VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
+            bufferInfo.size = size;
+            bufferInfo.usage = usage;
+            bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+            if(vkCreateBuffer(logicalDevice.get(), &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
+                std::cerr << "Cannot create buffer!\n";
+
+                VG_PROFILE_EXIT(13);
+                exit(13);
+            }
+
+            VkMemoryRequirements memReqs;
+            vkGetBufferMemoryRequirements(logicalDevice.get(), buffer, &memReqs);
+
+            VkMemoryAllocateInfo allocInfo{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+            allocInfo.allocationSize = memReqs.size;
+            allocInfo.memoryTypeIndex = findMemoryType(memReqs.memoryTypeBits, properties);
+
+            if(vkAllocateMemory(logicalDevice.get(), &allocInfo, nullptr, &memory) != VK_SUCCESS) {
+                std::cerr << "Cannot allocate buffer memory!\n";
+
+                VG_PROFILE_EXIT(14);
+                exit(14);
+            }
+
+            vkBindBufferMemory(logicalDevice.get(), buffer, memory, 0);
+        }
+
+        /**
+         * @brief Create buffer and allocate and bind memory for it, both owned by handles
+         * 
+         * @param size size of buffer in bytes
+         * @param usage buffer usage
+         * @param properties memory properties eg. VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+         * @param buffer created buffer, previous one is destroyed
+         * @param memory allocated memory, previous one is freed
+         */
+        void CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, BufferHandle& buffer, DeviceMemoryHandle& memory) {
+            VkBuffer rawBuffer;
+            VkDeviceMemory rawMemory;
+
+            CreateBuffer(size, usage, properties, rawBuffer, rawMemory);
+
+            buffer = BufferHandle(rawBuffer, {logicalDevice.get()});
+            memory = DeviceMemoryHandle(rawMemory, {logicalDevice.get()});
+        }
+
+        /**
+         * @brief Create 2D image and allocate and bind memory for it
+         * 
+         * @param width image width
+         * @param height image height
+         * @param mipLevels number of mip levels
+         * @param arrayLayers number of array layers
+         * @param format image format
+         * @param tiling image tiling
+         * @param usage image usage
+         * @param properties memory properties
+         * @param image created image
+         * @param memory allocated memory
+         * @param flags image create flags eg. VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT
+         */
+        void CreateImage(uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t arrayLayers, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& memory, VkImageCreateFlags flags = 0) {
+            VG_PROFILE_FUNCTION();
+
+            VkImageCreateInfo imageInfo{VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
+            imageInfo.flags = flags;
+            imageInfo.imageType = VK_IMAGE_TYPE_2D;
+            imageInfo.extent.width = width;
+            imageInfo.extent.height = height;
+            imageInfo.extent.depth = 1;
+            imageInfo.mipLevels = mipLevels;
+            imageInfo.arrayLayers = arrayLayers;
+            imageInfo.format = format;
+            imageInfo.tiling = tiling;
+            imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            imageInfo.usage = usage;
+            imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+            imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+            if(vkCreateImage(logicalDevice.get(), &imageInfo, nullptr, &image) != VK_SUCCESS) {
+                std::cerr << "Cannot create image!\n";
+
+                VG_PROFILE_EXIT(15);
+                exit(15);
+            }
+
+            VkMemoryRequirements memReqs;
+            vkGetImageMemoryRequirements(logicalDevice.get(), image, &memReqs);
+
+            VkMemoryAllocateInfo allocInfo{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+            allocInfo.allocationSize = memReqs.size;
+            allocInfo.memoryTypeIndex = findMemoryType(memReqs.memoryTypeBits, properties);
+
+            if(vkAllocateMemory(logicalDevice.get(), &allocInfo, nullptr, &memory) != VK_SUCCESS) {
+                std::cerr << "Cannot allocate image memory!\n";
+
+                VG_PROFILE_EXIT(16);
+                exit(16);
+            }
+
+            vkBindImageMemory(logicalDevice.get(), image, memory, 0);
+        }
+
+        /**
+         * @brief Create 2D image and allocate and bind memory for it, both owned by handles
+         * 
+         * @param width image width
+         * @param height image height
+         * @param mipLevels number of mip levels
+         * @param arrayLayers number of array layers
+         * @param format image format
+         * @param tiling image tiling
+         * @param usage image usage
+         * @param properties memory properties
+         * @param image created image, previous one is destroyed
+         * @param memory allocated memory, previous one is freed
+         * @param flags image create flags eg. VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT
+         */
+        void CreateImage(uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t arrayLayers, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, ImageHandle& image, DeviceMemoryHandle& memory, VkImageCreateFlags flags = 0) {
+            VkImage rawImage;
+            VkDeviceMemory rawMemory;
+
+            CreateImage(width, height, mipLevels, arrayLayers, format, tiling, usage, properties, rawImage, rawMemory, flags);
+
+            image = ImageHandle(rawImage, {logicalDevice.get()});
+            memory = DeviceMemoryHandle(rawMemory, {logicalDevice.get()});
+        }
+
+        /**
+         * @brief Create image view of mip levels and array layers range
+         * 
+         * @param image image
+         * @param format view format
+         * @param imageAspectFlags aspect eg. VK_IMAGE_ASPECT_COLOR_BIT
+         * @param baseMipLevel first mip level in view
+         * @param mipLevels number of mip levels in view
+         * @param baseArrayLayer first array layer in view
+         * @param layerCount number of array layers in view
+         * @param viewType view type eg. VK_IMAGE_VIEW_TYPE_2D_ARRAY or VK_IMAGE_VIEW_TYPE_CUBE
+         * @return VkImageView 
+         */
+        VkImageView CreateImageView(VkImage image, VkFormat format, VkImageAspectFlags imageAspectFlags, uint32_t baseMipLevel = 0, uint32_t mipLevels = 1, uint32_t baseArrayLayer = 0, uint32_t layerCount = 1, VkImageViewType viewType = VK_IMAGE_VIEW_TYPE_2D) {
+            VkImageViewCreateInfo imgViewInfo{VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO};
+            imgViewInfo.image = image;
+            imgViewInfo.viewType = viewType;
+            imgViewInfo.format = format;
+            imgViewInfo.subresourceRange.aspectMask = imageAspectFlags;
+            imgViewInfo.subresourceRange.baseMipLevel = baseMipLevel;
+            imgViewInfo.subresourceRange.levelCount = mipLevels;
+            imgViewInfo.subresourceRange.baseArrayLayer = baseArrayLayer;
+            imgViewInfo.subresourceRange.layerCount = layerCount;
+
+            VkImageView imageView;
+
+            if(vkCreateImageView(logicalDevice.get(), &imgViewInfo, nullptr, &imageView) != VK_SUCCESS) {
+                std::cerr << "Cannot create image view!\n";
+
+                VG_PROFILE_EXIT(8);
+                exit(8);
+            }
+
+            return imageView;
+        }
+
         /**
          * @brief Get the Physical Device Ptr
          * 
@@ -285,9 +638,9 @@ namespace vg {
         /**
          * @brief Get the Logical Device Ptr
          * 
-         * @return VkDevice* 
+         * @return const VkDevice* 
          */
-        VkDevice* getLogicalDevicePtr() { return &logicalDevice; }
+        const VkDevice* getLogicalDevicePtr() { return logicalDevice.getPtr(); }
 
         /**
          * @brief Get the Graphics Queue Ptr
@@ -304,21 +657,67 @@ namespace vg {
         VkQueue* getPresentQueuePtr() { return &presentQueue; }
 
         /**
-         * @brief Get the Instance Ptr 
+         * @brief Get the Compute Queue Ptr, same queue as graphics when device has no compute-only family
          * 
-         * @return VkInstance* 
+         * @return VkQueue* 
          */
-        Instance* getInstancePtr() { return _pInstance; }
+        VkQueue* getComputeQueuePtr() { return &computeQueue; }
 
         /**
-         * @brief Destroy the Vg_Device object call it manually for proper work
+         * @brief Check if compute queue is separate from graphics queue (work on it can overlap graphics)
          * 
+         * @return bool 
          */
-        ~Vg_Device() {
-            vkDestroyDevice(logicalDevice, nullptr);
+        bool hasAsyncCompute() { return asyncCompute; }
 
-            _pInstance->~Vg_Instance();
-        }
+        /**
+         * @brief Get queue families found when logical device was created
+         * 
+         * @return const QueueFamilyIndices& 
+         */
+        const QueueFamilyIndices& getQueueFamilies() { return queueFamilies; }
+
+        /**
+         * @brief Check if VK_KHR_present_id and VK_KHR_present_wait were enabled on logical device
+         * 
+         * @return true when swapchain can wait for presents
+         */
+        bool isPresentWaitEnabled() { return presentWaitEnabled; }
+
+        /**
+         * @brief Check if Vulkan 1.2 drawIndirectCount feature or VK_KHR_draw_indirect_count was enabled
+         * 
+         * @return true when vkCmdDrawIndexedIndirectCount (or its KHR alias) can be used
+         */
+        bool isDrawIndirectCountEnabled() { return drawIndirectCountEnabled; }
+
+        /**
+         * @brief Check if multiDrawIndirect feature was enabled (drawCount > 1 in indirect draws)
+         * 
+         * @return bool 
+         */
+        bool isMultiDrawIndirectEnabled() { return multiDrawIndirectEnabled; }
+
+        /**
+         * @brief Check if shaderStorageImageExtendedFormats feature was enabled (eg. rg32f storage images)
+         * 
+         * @return bool 
+         */
+        bool isStorageImageExtendedFormatsEnabled() { return storageImageExtendedFormatsEnabled; }
+
+        /**
+         * @brief Check if VK_KHR_synchronization2 was enabled (vkQueueSubmit2KHR)
+         * 
+         * @return bool 
+         */
+        bool isSynchronization2Enabled() { return synchronization2Enabled; }
+
+        /**
+         * @brief Get the Instance Ptr 
+         * 
+         * @return VkInstance* 
+         */
+        Instance* getInstancePtr() { return _pInstance; }
     };
 
     typedef Vg_Device Device;
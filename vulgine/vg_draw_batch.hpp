@@ -0,0 +1,525 @@
+#pragma once
+#define VG_DRAW_BATCH 1
+
+#ifndef VG_DEVICES
+#include "vg_devices.hpp"
+#endif
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define VG_AVX 1
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define VG_SSE 1
+#endif
+
+namespace vg {
+    /**
+     * @brief View frustum planes (a, b, c, d), point is inside when a * x + b * y + c * z + d >= 0
+     * 
+     */
+    struct Frustum {
+        float planes[6][4];
+
+        /**
+         * @brief Extract frustum planes from column-major view-projection matrix (GLM layout, Vulkan 0..1 depth)
+         * 
+         * @param m 16 floats of view-projection matrix
+         * @return Frustum
+         */
+        static Frustum fromMatrix(const float* m) {
+            Frustum frustum;
+
+            for(int i = 0; i < 4; i++) {
+                frustum.planes[0][i] = m[i * 4 + 3] + m[i * 4 + 0]; // left
+                frustum.planes[1][i] = m[i * 4 + 3] - m[i * 4 + 0]; // right
+                frustum.planes[2][i] = m[i * 4 + 3] + m[i * 4 + 1]; // bottom
+                frustum.planes[3][i] = m[i * 4 + 3] - m[i * 4 + 1]; // top
+                frustum.planes[4][i] = m[i * 4 + 2];                // near
+                frustum.planes[5][i] = m[i * 4 + 3] - m[i * 4 + 2]; // far
+            }
+
+            for(auto& plane : frustum.planes) {
+                float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+
+                if(length > 0.0f) {
+                    for(int i = 0; i < 4; i++) {
+                        plane[i] /= length;
+                    }
+                }
+            }
+
+            return frustum;
+        }
+    };
+
+    /**
+     * @brief Single indexed draw, keys are user defined (eg. index of pipeline and material)
+     * 
+     */
+    struct DrawCommand {
+        uint64_t pipelineKey;
+        uint64_t materialKey;
+        uint32_t indexCount;
+        uint32_t instanceCount;
+        uint32_t firstIndex;
+        int32_t vertexOffset;
+        uint32_t firstInstance;
+    };
+
+    /**
+     * @brief Range of indirect commands sharing pipeline and material
+     * 
+     */
+    struct DrawBatch {
+        uint64_t pipelineKey;
+        uint64_t materialKey;
+        uint32_t firstCommand;
+        uint32_t commandCount;
+    };
+
+    class Vg_DrawBatcher {
+    private:
+        /**
+         * @brief Buffers written by Build of one frame in flight, GPU may still read the ones of other frames
+         * 
+         */
+        struct FrameBuffers {
+            // Memory stays mapped until it's freed, freeing unmaps it
+            DeviceMemoryHandle indirectMemory;
+            BufferHandle indirectBuffer;
+            VkDrawIndexedIndirectCommand* pIndirectCommands = nullptr;
+
+            DeviceMemoryHandle countMemory;
+            BufferHandle countBuffer;
+            uint32_t* pDrawCounts = nullptr;
+
+            // Bounding sphere of every written command, read by GPU culling (Vg_HiZ)
+            DeviceMemoryHandle boundsMemory;
+            BufferHandle boundsBuffer;
+            float* pBounds = nullptr;
+
+            // Device-local copy of indirect commands that GPU culling (Vg_HiZ) writes and draws read, only with GPU culling
+            DeviceMemoryHandle cullMemory;
+            BufferHandle cullBuffer;
+        };
+
+        Device* pDevice = nullptr;
+
+        uint32_t maxDraws = 0;
+        uint32_t maxBatches = 0;
+
+        bool gpuCulling = false;
+
+        std::vector<FrameBuffers> frames;
+
+        // Core vkCmdDrawIndexedIndirectCount or its VK_KHR_draw_indirect_count alias, null when device has neither
+        PFN_vkCmdDrawIndexedIndirectCountKHR drawIndexedIndirectCount = nullptr;
+
+        uint32_t commandsCount = 0;
+
+        std::vector<DrawCommand> draws;
+
+        // Bounding spheres are kept as SoA, so culling loads 4/8 spheres per instruction
+        std::vector<float> centerX;
+        std::vector<float> centerY;
+        std::vector<float> centerZ;
+        std::vector<float> radius;
+
+        std::vector<uint32_t> visibleDraws;
+        std::vector<DrawBatch> batches;
+
+        void pushVisibleMask(int mask, uint32_t first, int lanes) {
+            for(int lane = 0; lane < lanes; lane++) {
+                if(mask & (1 << lane)) {
+                    visibleDraws.push_back(first + lane);
+                }
+            }
+        }
+
+    public:
+        /**
+         * @brief Create indirect, count and bounds buffers for every frame in flight
+         * 
+         * @param _pDevice pointer to created Device
+         * @param _maxDraws maximum number of draws per frame
+         * @param _maxBatches maximum number of pipeline/material batches per frame
+         * @param framesInFlight number of frames that can be in flight, each gets own buffers
+         */
+        void CreateDrawBatcher(Device* _pDevice, uint32_t _maxDraws, uint32_t _maxBatches, uint32_t framesInFlight) {
+            pDevice = _pDevice;
+            maxDraws = _maxDraws;
+            maxBatches = _maxBatches;
+
+            VkDevice device = *pDevice->getLogicalDevicePtr();
+            VkMemoryPropertyFlags hostMemory = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+            frames.clear();
+            frames.resize(std::max(framesInFlight, 1u));
+
+            for(auto& frame : frames) {
+                pDevice->CreateBuffer(sizeof(VkDrawIndexedIndirectCommand) * maxDraws, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT, hostMemory, frame.indirectBuffer, frame.indirectMemory);
+                pDevice->CreateBuffer(sizeof(uint32_t) * maxBatches, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, hostMemory, frame.countBuffer, frame.countMemory);
+                pDevice->CreateBuffer(sizeof(float) * 4 * maxDraws, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, hostMemory, frame.boundsBuffer, frame.boundsMemory);
+
+                if(gpuCulling) {
+                    pDevice->CreateBuffer(sizeof(VkDrawIndexedIndirectCommand) * maxDraws, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, frame.cullBuffer, frame.cullMemory);
+                }
+
+                if(vkMapMemory(device, frame.indirectMemory.get(), 0, VK_WHOLE_SIZE, 0, (void**)&frame.pIndirectCommands) != VK_SUCCESS ||
+                    vkMapMemory(device, frame.countMemory.get(), 0, VK_WHOLE_SIZE, 0, (void**)&frame.pDrawCounts) != VK_SUCCESS ||
+                    vkMapMemory(device, frame.boundsMemory.get(), 0, VK_WHOLE_SIZE, 0, (void**)&frame.pBounds) != VK_SUCCESS) {
+                    std::cerr << "Cannot map draw batcher memory!\n";
+
+                    VG_PROFILE_EXIT(34);
+                    exit(34);
+                }
+            }
+
+            drawIndexedIndirectCount = nullptr;
+
+            if(pDevice->isDrawIndirectCountEnabled()) {
+                drawIndexedIndirectCount = (PFN_vkCmdDrawIndexedIndirectCountKHR)vkGetDeviceProcAddr(device, "vkCmdDrawIndexedIndirectCount");
+
+                if(drawIndexedIndirectCount == nullptr) {
+                    drawIndexedIndirectCount = (PFN_vkCmdDrawIndexedIndirectCountKHR)vkGetDeviceProcAddr(device, "vkCmdDrawIndexedIndirectCountKHR");
+                }
+            }
+
+            draws.reserve(maxDraws);
+            centerX.reserve(maxDraws);
+            centerY.reserve(maxDraws);
+            centerZ.reserve(maxDraws);
+            radius.reserve(maxDraws);
+            visibleDraws.reserve(maxDraws);
+            batches.reserve(maxBatches);
+        }
+
+        /**
+         * @brief Remove all draws, call at start of frame
+         * 
+         */
+        void Clear() {
+            draws.clear();
+            centerX.clear();
+            centerY.clear();
+            centerZ.clear();
+            radius.clear();
+            visibleDraws.clear();
+            batches.clear();
+            commandsCount = 0;
+        }
+
+        /**
+         * @brief Add draw with world space bounding sphere
+         * 
+         * @param draw draw command and its sort keys
+         * @param center bounding sphere center (3 floats)
+         * @param sphereRadius bounding sphere radius
+         * @return uint32_t index of draw
+         */
+        uint32_t AddDraw(const DrawCommand& draw, const float* center, float sphereRadius) {
+            draws.push_back(draw);
+            centerX.push_back(center[0]);
+            centerY.push_back(center[1]);
+            centerZ.push_back(center[2]);
+            radius.push_back(sphereRadius);
+
+            return draws.size() - 1;
+        }
+
+        /**
+         * @brief Test bounding spheres of all draws against frustum (AVX/SSE when compiled with them)
+         * 
+         * @param frustum
+         */
+        void Cull(const Frustum& frustum) {
+            VG_PROFILE_FUNCTION();
+
+            visibleDraws.clear();
+
+            uint32_t count = draws.size();
+            uint32_t i = 0;
+
+        #if defined(VG_AVX)
+            for(; i + 8 <= count; i += 8) {
+                __m256 x = _mm256_loadu_ps(&centerX[i]);
+                __m256 y = _mm256_loadu_ps(&centerY[i]);
+                __m256 z = _mm256_loadu_ps(&centerZ[i]);
+                __m256 negRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(&radius[i]));
+
+                __m256 inside = _mm256_cmp_ps(negRadius, negRadius, _CMP_EQ_OQ);
+
+                for(const auto& plane : frustum.planes) {
+                    __m256 distance = _mm256_add_ps(
+                        _mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(plane[0])), _mm256_mul_ps(y, _mm256_set1_ps(plane[1]))),
+                        _mm256_add_ps(_mm256_mul_ps(z, _mm256_set1_ps(plane[2])), _mm256_set1_ps(plane[3])));
+
+                    inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negRadius, _CMP_GE_OQ));
+                }
+
+                pushVisibleMask(_mm256_movemask_ps(inside), i, 8);
+            }
+        #elif defined(VG_SSE)
+            for(; i + 4 <= count; i += 4) {
+                __m128 x = _mm_loadu_ps(&centerX[i]);
+                __m128 y = _mm_loadu_ps(&centerY[i]);
+                __m128 z = _mm_loadu_ps(&centerZ[i]);
+                __m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&radius[i]));
+
+                __m128 inside = _mm_cmpeq_ps(negRadius, negRadius);
+
+                for(const auto& plane : frustum.planes) {
+                    __m128 distance = _mm_add_ps(
+                        _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(plane[0])), _mm_mul_ps(y, _mm_set1_ps(plane[1]))),
+                        _mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(plane[2])), _mm_set1_ps(plane[3])));
+
+                    inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negRadius));
+                }
+
+                pushVisibleMask(_mm_movemask_ps(inside), i, 4);
+            }
+        #endif
+
+            for(; i < count; i++) {
+                bool inside = true;
+
+                for(const auto& plane : frustum.planes) {
+                    if(centerX[i] * plane[0] + centerY[i] * plane[1] + centerZ[i] * plane[2] + plane[3] < -radius[i]) {
+                        inside = false;
+
+                        break;
+                    }
+                }
+
+                if(inside) {
+                    visibleDraws.push_back(i);
+                }
+            }
+        }
+
+        /**
+         * @brief Mark every draw as visible (skip frustum culling)
+         * 
+         */
+        void SkipCulling() {
+            visibleDraws.resize(draws.size());
+
+            for(uint32_t i = 0; i < visibleDraws.size(); i++) {
+                visibleDraws[i] = i;
+            }
+        }
+
+        /**
+         * @brief Sort visible draws by pipeline and material and write them to indirect buffer of frame, call after Cull.
+         * Buffers of frameIndex must not be in use by GPU (fence of that frame waited)
+         * 
+         * @param frameIndex index of frame in flight
+         */
+        void Build(uint32_t frameIndex) {
+            VG_PROFILE_FUNCTION();
+
+            FrameBuffers& frame = frames[frameIndex];
+
+            std::sort(visibleDraws.begin(), visibleDraws.end(), [&](uint32_t a, uint32_t b) {
+                if(draws[a].pipelineKey != draws[b].pipelineKey) {
+                    return draws[a].pipelineKey < draws[b].pipelineKey;
+                }
+
+                if(draws[a].materialKey != draws[b].materialKey) {
+                    return draws[a].materialKey < draws[b].materialKey;
+                }
+
+                return a < b;
+            });
+
+            batches.clear();
+
+            uint32_t written = 0;
+
+            for(uint32_t index : visibleDraws) {
+                const DrawCommand& draw = draws[index];
+
+                if(batches.empty() || batches.back().pipelineKey != draw.pipelineKey || batches.back().materialKey != draw.materialKey) {
+                    if(batches.size() >= maxBatches) {
+                        std::cerr << "Too many draw batches, rest of draws is skipped!\n";
+
+                        break;
+                    }
+
+                    batches.push_back({draw.pipelineKey, draw.materialKey, written, 0});
+                }
+
+                if(written >= maxDraws) {
+                    std::cerr << "Too many draws, rest of draws is skipped!\n";
+
+                    break;
+                }
+
+                frame.pIndirectCommands[written] = {draw.indexCount, draw.instanceCount, draw.firstIndex, draw.vertexOffset, draw.firstInstance};
+
+                frame.pBounds[written * 4 + 0] = centerX[index];
+                frame.pBounds[written * 4 + 1] = centerY[index];
+                frame.pBounds[written * 4 + 2] = centerZ[index];
+                frame.pBounds[written * 4 + 3] = radius[index];
+
+                batches.back().commandCount++;
+                written++;
+            }
+
+            if(!batches.empty() && batches.back().commandCount == 0) {
+                batches.pop_back();
+            }
+
+            commandsCount = written;
+
+            for(uint32_t b = 0; b < batches.size(); b++) {
+                frame.pDrawCounts[b] = batches[b].commandCount;
+            }
+        }
+
+        /**
+         * @brief Record copy of commands written by last Build to device-local indirect buffer, call outside of render pass
+         * after Build and before Vg_HiZ::RecordCull. Does nothing without GPU culling
+         * 
+         * @param commandBuffer command buffer outside of render pass
+         * @param frameIndex same index of frame in flight as in last Build
+         */
+        void RecordUpload(VkCommandBuffer commandBuffer, uint32_t frameIndex) {
+            if(!gpuCulling || commandsCount == 0) {
+                return;
+            }
+
+            // Host writes are visible to transfer on submit, previous reads of this frame's buffer finished with its fence
+            VkBufferCopy region{};
+            region.size = sizeof(VkDrawIndexedIndirectCommand) * commandsCount;
+
+            vkCmdCopyBuffer(commandBuffer, frames[frameIndex].indirectBuffer.get(), frames[frameIndex].cullBuffer.get(), 1, &region);
+
+            VkBufferMemoryBarrier barrier{VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER};
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.buffer = frames[frameIndex].cullBuffer.get();
+            barrier.offset = 0;
+            barrier.size = region.size;
+
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+        }
+
+        /**
+         * @brief Record one indirect draw per batch of last Build, bindBatch is called before each batch to bind pipeline, descriptors and buffers
+         * 
+         * @param commandBuffer command buffer inside render pass
+         * @param frameIndex same index of frame in flight as in last Build
+         * @param bindBatch callback(commandBuffer, batch, pipelineChanged)
+         */
+        void Record(VkCommandBuffer commandBuffer, uint32_t frameIndex, const std::function<void(VkCommandBuffer, const DrawBatch&, bool)>& bindBatch) {
+            const uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+
+            VkBuffer indirectBuffer = *getIndirectBufferPtr(frameIndex);
+            VkBuffer countBuffer = frames[frameIndex].countBuffer.get();
+
+            for(uint32_t b = 0; b < batches.size(); b++) {
+                const DrawBatch& batch = batches[b];
+
+                bindBatch(commandBuffer, batch, b == 0 || batches[b - 1].pipelineKey != batch.pipelineKey);
+
+                VkDeviceSize offset = (VkDeviceSize)batch.firstCommand * stride;
+
+                if(drawIndexedIndirectCount != nullptr && pDevice->isMultiDrawIndirectEnabled()) {
+                    drawIndexedIndirectCount(commandBuffer, indirectBuffer, offset, countBuffer, b * sizeof(uint32_t), batch.commandCount, stride);
+                }
+                else if(pDevice->isMultiDrawIndirectEnabled()) {
+                    vkCmdDrawIndexedIndirect(commandBuffer, indirectBuffer, offset, batch.commandCount, stride);
+                }
+                else {
+                    for(uint32_t c = 0; c < batch.commandCount; c++) {
+                        vkCmdDrawIndexedIndirect(commandBuffer, indirectBuffer, offset + c * stride, 1, stride);
+                    }
+                }
+            }
+        }
+
+        /**
+         * @brief Get batches built in last Build call
+         * 
+         * @return const std::vector<DrawBatch>&
+         */
+        const std::vector<DrawBatch>& getBatches() { return batches; }
+
+        /**
+         * @brief Get number of draws that passed culling
+         * 
+         * @return uint32_t
+         */
+        uint32_t getVisibleDrawsCount() { return visibleDraws.size(); }
+
+        /**
+         * @brief Get number of commands written to indirect buffer in last Build call
+         * 
+         * @return uint32_t 
+         */
+        uint32_t getCommandsCount() { return commandsCount; }
+
+        /**
+         * @brief Get maximum number of draws per frame
+         * 
+         * @return uint32_t 
+         */
+        uint32_t getMaxDraws() { return maxDraws; }
+
+        /**
+         * @brief Get number of frames in flight with own buffers
+         * 
+         * @return uint32_t 
+         */
+        uint32_t getFramesInFlight() { return frames.size(); }
+
+        /**
+         * @brief Cull draws on GPU (Vg_HiZ), commands are then copied to device-local buffer by RecordUpload. Call before CreateDrawBatcher
+         * 
+         * @param enable 
+         */
+        void setGpuCulling(bool enable) { gpuCulling = enable; }
+
+        /**
+         * @brief Check if batcher was created with GPU culling
+         * 
+         * @return true when draws read device-local buffer filled by RecordUpload
+         */
+        bool isGpuCullingEnabled() { return gpuCulling; }
+
+        /**
+         * @brief Get the Indirect Buffer Ptr of frame that draws read, device-local buffer with GPU culling, otherwise host-visible one written by Build
+         * 
+         * @param frameIndex
+         * @return const VkBuffer*
+         */
+        const VkBuffer* getIndirectBufferPtr(uint32_t frameIndex) { return gpuCulling ? frames[frameIndex].cullBuffer.getPtr() : frames[frameIndex].indirectBuffer.getPtr(); }
+
+        /**
+         * @brief Get the Count Buffer Ptr of frame
+         * 
+         * @param frameIndex
+         * @return const VkBuffer*
+         */
+        const VkBuffer* getCountBufferPtr(uint32_t frameIndex) { return frames[frameIndex].countBuffer.getPtr(); }
+
+        /**
+         * @brief Get the Bounds Buffer Ptr of frame, vec4(center, radius) per command in indirect buffer
+         * 
+         * @param frameIndex
+         * @return const VkBuffer* 
+         */
+        const VkBuffer* getBoundsBufferPtr(uint32_t frameIndex) { return frames[frameIndex].boundsBuffer.getPtr(); }
+    };
+
+    typedef Vg_DrawBatcher DrawBatcher;
+}
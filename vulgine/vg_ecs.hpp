@@ -0,0 +1,911 @@
+#pragma once
+#define VG_ECS 1
+
+#ifndef VG_DEVICES
+#include "vg_devices.hpp"
+#endif
+
+#include <vector>
+#include <array>
+#include <map>
+#include <deque>
+#include <algorithm>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <type_traits>
+#include <functional>
+#include <cstring>
+#include <cstddef>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace vg {
+    /**
+     * @brief Entity id, index is reused after destroy with bumped generation
+     * 
+     */
+    struct Entity {
+        uint32_t index = UINT32_MAX;
+        uint32_t generation = 0;
+
+        bool operator==(const Entity& other) const { return index == other.index && generation == other.generation; }
+        bool operator!=(const Entity& other) const { return !(*this == other); }
+    };
+
+    /**
+     * @brief Model matrix, column-major (std430 mat4)
+     * 
+     */
+    struct Transform {
+        float model[16];
+    };
+
+    /**
+     * @brief Material parameters (std430, 32 bytes)
+     * 
+     */
+    struct Material {
+        float baseColor[4];
+        float metallic;
+        float roughness;
+        uint32_t textureIndex;
+        uint32_t flags;
+    };
+
+    const uint32_t maxComponentTypes = 64;
+    const uint32_t ecsChunkSize = 16 * 1024;
+
+    // Removals older than this many versions are forgotten, consumers that lag more must rewrite everything
+    const uint64_t ecsRemovalHistory = 256;
+
+    struct ComponentInfo {
+        uint32_t size;
+        uint32_t alignment;
+    };
+
+    inline std::array<ComponentInfo, maxComponentTypes>& componentInfos() {
+        static std::array<ComponentInfo, maxComponentTypes> infos{};
+
+        return infos;
+    }
+
+    inline uint32_t registerComponent(uint32_t size, uint32_t alignment) {
+        static std::atomic<uint32_t> nextId{0};
+
+        uint32_t id = nextId++;
+
+        if(id >= maxComponentTypes) {
+            std::cerr << "Too many component types!\n";
+
+            VG_PROFILE_EXIT(28);
+            exit(28);
+        }
+
+        componentInfos()[id] = {size, alignment};
+
+        return id;
+    }
+
+    /**
+     * @brief Id of component type, assigned on first use
+     * 
+     * @return uint32_t
+     */
+    template<typename T>
+    uint32_t componentId() {
+        static_assert(std::is_trivially_copyable<T>::value, "Components must be trivially copyable");
+        static_assert(alignof(T) <= alignof(std::max_align_t), "Component alignment is too big");
+
+        static const uint32_t id = registerComponent(sizeof(T), alignof(T));
+
+        return id;
+    }
+
+    /**
+     * @brief Fixed size block holding rows of one archetype as SoA:
+     * entities column followed by one column per component
+     * 
+     */
+    struct EcsChunk {
+        std::unique_ptr<uint8_t[]> data;
+        uint32_t count = 0;
+
+        // World version of last write into column, per archetype component
+        std::vector<uint64_t> versions;
+    };
+
+    /**
+     * @brief All entities with same set of components
+     * 
+     */
+    struct Archetype {
+        uint64_t mask = 0;
+        std::vector<uint32_t> components;
+        std::vector<uint32_t> offsets;
+        uint32_t capacity = 0;
+        uint32_t chunkBytes = 0;
+
+        std::vector<EcsChunk> chunks;
+
+        int column(uint32_t component) const {
+            for(size_t i = 0; i < components.size(); i++) {
+                if(components[i] == component) {
+                    return i;
+                }
+            }
+
+            return -1;
+        }
+    };
+
+    /**
+     * @brief Persistent worker threads for parallel loops, calling thread takes part in every loop
+     * 
+     */
+    class Vg_JobPool {
+    private:
+        std::vector<std::thread> workers;
+
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable done;
+
+        const std::function<void(uint32_t)>* job = nullptr;
+        uint32_t jobSize = 0;
+        std::atomic<uint32_t> nextItem{0};
+        uint32_t activeWorkers = 0;
+        uint64_t generation = 0;
+        bool stopping = false;
+
+        void runItems() {
+            for(uint32_t i = nextItem++; i < jobSize; i = nextItem++) {
+                (*job)(i);
+            }
+        }
+
+        void workerLoop() {
+            VG_PROFILE_THREAD("JobPool worker");
+
+            uint64_t seenGeneration = 0;
+
+            std::unique_lock<std::mutex> lock(mutex);
+
+            while(true) {
+                wake.wait(lock, [&]() { return stopping || generation != seenGeneration; });
+
+                if(stopping) {
+                    return;
+                }
+
+                seenGeneration = generation;
+
+                lock.unlock();
+                runItems();
+                lock.lock();
+
+                if(--activeWorkers == 0) {
+                    done.notify_one();
+                }
+            }
+        }
+
+    public:
+        Vg_JobPool() = default;
+        Vg_JobPool(const Vg_JobPool&) = delete;
+        Vg_JobPool& operator=(const Vg_JobPool&) = delete;
+
+        /**
+         * @brief Start worker threads
+         * 
+         * @param threadCount worker threads besides calling one (0 for hardware threads - 1)
+         */
+        void CreateJobPool(uint32_t threadCount = 0) {
+            if(threadCount == 0) {
+                threadCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+            }
+
+            for(uint32_t i = 0; i < threadCount; i++) {
+                workers.emplace_back(&Vg_JobPool::workerLoop, this);
+            }
+        }
+
+        /**
+         * @brief Call func(i) for every i in [0, count) on workers and calling thread, returns when all finished
+         * 
+         * @param count
+         * @param func must be safe to call concurrently
+         */
+        void ParallelFor(uint32_t count, const std::function<void(uint32_t)>& func) {
+            VG_PROFILE_FUNCTION();
+
+            if(count == 0) {
+                return;
+            }
+
+            if(workers.empty() || count == 1) {
+                for(uint32_t i = 0; i < count; i++) {
+                    func(i);
+                }
+
+                return;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+
+                job = &func;
+                jobSize = count;
+                nextItem = 0;
+                activeWorkers = workers.size();
+                generation++;
+            }
+
+            wake.notify_all();
+
+            runItems();
+
+            std::unique_lock<std::mutex> lock(mutex);
+            done.wait(lock, [&]() { return activeWorkers == 0; });
+
+            job = nullptr;
+        }
+
+        /**
+         * @brief Get the Workers Count (without calling thread)
+         * 
+         * @return uint32_t
+         */
+        uint32_t getWorkersCount() { return workers.size(); }
+
+        ~Vg_JobPool() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+
+                stopping = true;
+            }
+
+            wake.notify_all();
+
+            for(std::thread& worker : workers) {
+                worker.join();
+            }
+        }
+    };
+
+    typedef Vg_JobPool JobPool;
+
+    /**
+     * @brief Archetype entity component store
+     * 
+     * Entities with same components share archetype, their components are stored in 16KB SoA chunks,
+     * so systems walk contiguous arrays instead of chasing pointers.
+     * Every write (SetComponent, non-const ForEach parameter, new row) stamps chunk column with current version,
+     * NextVersion closes version, so consumers (eg. Vg_SceneBuffer) pick only chunks changed since their last read.
+     * Destroyed entities and removed components are logged, so consumers can also clear what no longer exists.
+     * Structural changes (create/destroy, add/remove component) mustn't happen during ForEach.
+     */
+    class Vg_World {
+    private:
+        struct EntityRecord {
+            uint32_t archetype = 0;
+            uint32_t chunk = 0;
+            uint32_t row = 0;
+            uint32_t generation = 0;
+            bool alive = false;
+        };
+
+        struct Removal {
+            uint64_t version;
+            uint32_t index;
+            uint64_t mask;
+        };
+
+        std::vector<Archetype> archetypes;
+        std::map<uint64_t, uint32_t> archetypeLookup;
+
+        std::vector<EntityRecord> records;
+        std::vector<uint32_t> freeIndices;
+
+        uint64_t version = 1;
+
+        // Oldest first, every removal at or below trimmedVersion was dropped
+        std::deque<Removal> removals;
+        uint64_t trimmedVersion = 0;
+
+        static uint32_t alignUp(uint32_t value, uint32_t alignment) {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+
+        static uint32_t chunkLayout(const Archetype& archetype, uint32_t capacity, std::vector<uint32_t>* offsets) {
+            uint32_t bytes = alignUp(sizeof(Entity) * capacity, alignof(std::max_align_t));
+
+            for(uint32_t component : archetype.components) {
+                if(offsets != nullptr) {
+                    offsets->push_back(bytes);
+                }
+
+                bytes = alignUp(bytes + componentInfos()[component].size * capacity, alignof(std::max_align_t));
+            }
+
+            return bytes;
+        }
+
+        uint32_t getArchetype(uint64_t mask) {
+            auto found = archetypeLookup.find(mask);
+
+            if(found != archetypeLookup.end()) {
+                return found->second;
+            }
+
+            Archetype archetype;
+            archetype.mask = mask;
+
+            uint32_t rowSize = sizeof(Entity);
+
+            for(uint32_t component = 0; component < maxComponentTypes; component++) {
+                if(mask & (1ull << component)) {
+                    archetype.components.push_back(component);
+                    rowSize += componentInfos()[component].size;
+                }
+            }
+
+            archetype.capacity = std::max(ecsChunkSize / rowSize, 1u);
+
+            while(archetype.capacity > 1 && chunkLayout(archetype, archetype.capacity, nullptr) > ecsChunkSize) {
+                archetype.capacity--;
+            }
+
+            archetype.chunkBytes = std::max(chunkLayout(archetype, archetype.capacity, &archetype.offsets), ecsChunkSize);
+
+            archetypes.push_back(std::move(archetype));
+            archetypeLookup[mask] = archetypes.size() - 1;
+
+            return archetypes.size() - 1;
+        }
+
+        Entity* entitiesOf(EcsChunk& chunk) {
+            return reinterpret_cast<Entity*>(chunk.data.get());
+        }
+
+        uint8_t* componentOf(Archetype& archetype, EcsChunk& chunk, int column, uint32_t row) {
+            return chunk.data.get() + archetype.offsets[column] + componentInfos()[archetype.components[column]].size * row;
+        }
+
+        /**
+         * @brief Append row at end of archetype, components are left uninitialized and stamped as changed
+         */
+        void allocateRow(uint32_t archetypeIndex, Entity entity, uint32_t& chunkIndex, uint32_t& row) {
+            Archetype& archetype = archetypes[archetypeIndex];
+
+            if(archetype.chunks.empty() || archetype.chunks.back().count == archetype.capacity) {
+                EcsChunk chunk;
+                chunk.data.reset(new uint8_t[archetype.chunkBytes]);
+                chunk.versions.assign(archetype.components.size(), 0);
+
+                archetype.chunks.push_back(std::move(chunk));
+            }
+
+            EcsChunk& chunk = archetype.chunks.back();
+
+            chunkIndex = archetype.chunks.size() - 1;
+            row = chunk.count++;
+
+            entitiesOf(chunk)[row] = entity;
+
+            for(uint64_t& columnVersion : chunk.versions) {
+                columnVersion = version;
+            }
+        }
+
+        /**
+         * @brief Remove row by moving last row of archetype into it, so all chunks except last stay full.
+         * Moved components keep their values, target chunk only takes newer column versions of last chunk
+         * so writes of moved row aren't lost for ForEachChangedChunk.
+         */
+        void removeRow(uint32_t archetypeIndex, uint32_t chunkIndex, uint32_t row) {
+            Archetype& archetype = archetypes[archetypeIndex];
+            EcsChunk& last = archetype.chunks.back();
+            uint32_t lastRow = last.count - 1;
+
+            if(chunkIndex != archetype.chunks.size() - 1 || row != lastRow) {
+                EcsChunk& chunk = archetype.chunks[chunkIndex];
+                Entity moved = entitiesOf(last)[lastRow];
+
+                entitiesOf(chunk)[row] = moved;
+
+                for(size_t column = 0; column < archetype.components.size(); column++) {
+                    memcpy(componentOf(archetype, chunk, column, row), componentOf(archetype, last, column, lastRow), componentInfos()[archetype.components[column]].size);
+
+                    chunk.versions[column] = std::max(chunk.versions[column], last.versions[column]);
+                }
+
+                records[moved.index].chunk = chunkIndex;
+                records[moved.index].row = row;
+            }
+
+            last.count--;
+
+            if(last.count == 0) {
+                archetype.chunks.pop_back();
+            }
+        }
+
+        void moveEntity(Entity entity, uint64_t mask) {
+            uint32_t target = getArchetype(mask);
+
+            EntityRecord& record = records[entity.index];
+
+            uint64_t removedMask = archetypes[record.archetype].mask & ~mask;
+
+            if(removedMask != 0) {
+                removals.push_back({version, entity.index, removedMask});
+            }
+
+            uint32_t chunkIndex, row;
+            allocateRow(target, entity, chunkIndex, row);
+
+            Archetype& from = archetypes[record.archetype];
+            Archetype& to = archetypes[target];
+
+            for(size_t column = 0; column < from.components.size(); column++) {
+                int targetColumn = to.column(from.components[column]);
+
+                if(targetColumn >= 0) {
+                    memcpy(componentOf(to, to.chunks[chunkIndex], targetColumn, row), componentOf(from, from.chunks[record.chunk], column, record.row), componentInfos()[from.components[column]].size);
+                }
+            }
+
+            removeRow(record.archetype, record.chunk, record.row);
+
+            record.archetype = target;
+            record.chunk = chunkIndex;
+            record.row = row;
+        }
+
+        template<typename T>
+        void writeComponent(const EntityRecord& record, const T& component) {
+            Archetype& archetype = archetypes[record.archetype];
+            EcsChunk& chunk = archetype.chunks[record.chunk];
+            int column = archetype.column(componentId<T>());
+
+            memcpy(componentOf(archetype, chunk, column, record.row), &component, sizeof(T));
+            chunk.versions[column] = version;
+        }
+
+        template<typename... Ts>
+        static uint64_t queryMask() {
+            return (0ull | ... | (1ull << componentId<std::remove_const_t<Ts>>()));
+        }
+
+        template<typename T>
+        T* columnOf(Archetype& archetype, EcsChunk& chunk) {
+            int column = archetype.column(componentId<std::remove_const_t<T>>());
+
+            if(!std::is_const<T>::value) {
+                chunk.versions[column] = version;
+            }
+
+            return reinterpret_cast<T*>(chunk.data.get() + archetype.offsets[column]);
+        }
+
+        template<typename... Ts, typename F, size_t... I>
+        void runChunk(Archetype& archetype, EcsChunk& chunk, F& func, std::index_sequence<I...>) {
+            const Entity* entities = entitiesOf(chunk);
+            std::tuple<Ts*...> columns{columnOf<Ts>(archetype, chunk)...};
+
+            for(uint32_t row = 0; row < chunk.count; row++) {
+                func(entities[row], std::get<I>(columns)[row]...);
+            }
+        }
+
+    public:
+        /**
+         * @brief Create entity with given components
+         * 
+         * @param components
+         * @return Entity
+         */
+        template<typename... Ts>
+        Entity CreateEntity(const Ts&... components) {
+            Entity entity;
+
+            if(!freeIndices.empty()) {
+                entity.index = freeIndices.back();
+                freeIndices.pop_back();
+            }
+            else {
+                entity.index = records.size();
+                records.emplace_back();
+            }
+
+            entity.generation = records[entity.index].generation;
+
+            uint32_t archetypeIndex = getArchetype(queryMask<Ts...>());
+
+            EntityRecord& record = records[entity.index];
+            record.archetype = archetypeIndex;
+            record.alive = true;
+
+            allocateRow(archetypeIndex, entity, record.chunk, record.row);
+
+            (writeComponent(record, components), ...);
+
+            return entity;
+        }
+
+        /**
+         * @brief Destroy entity, its index is reused by next CreateEntity
+         * 
+         * @param entity
+         */
+        void DestroyEntity(Entity entity) {
+            if(!IsAlive(entity)) {
+                return;
+            }
+
+            EntityRecord& record = records[entity.index];
+
+            removals.push_back({version, entity.index, archetypes[record.archetype].mask});
+
+            removeRow(record.archetype, record.chunk, record.row);
+
+            record.alive = false;
+            record.generation++;
+
+            freeIndices.push_back(entity.index);
+        }
+
+        /**
+         * @brief Check if entity wasn't destroyed
+         * 
+         * @param entity
+         * @return bool
+         */
+        bool IsAlive(Entity entity) {
+            return entity.index < records.size() && records[entity.index].alive && records[entity.index].generation == entity.generation;
+        }
+
+        /**
+         * @brief Check if entity has component
+         * 
+         * @param entity
+         * @return bool
+         */
+        template<typename T>
+        bool HasComponent(Entity entity) {
+            return IsAlive(entity) && (archetypes[records[entity.index].archetype].mask & (1ull << componentId<T>()));
+        }
+
+        /**
+         * @brief Add component (moves entity to other archetype), sets value if entity already has it
+         * 
+         * @param entity
+         * @param component
+         */
+        template<typename T>
+        void AddComponent(Entity entity, const T& component) {
+            if(!IsAlive(entity)) {
+                return;
+            }
+
+            uint64_t mask = archetypes[records[entity.index].archetype].mask;
+
+            if(!(mask & (1ull << componentId<T>()))) {
+                moveEntity(entity, mask | (1ull << componentId<T>()));
+            }
+
+            writeComponent(records[entity.index], component);
+        }
+
+        /**
+         * @brief Remove component (moves entity to other archetype)
+         * 
+         * @param entity
+         */
+        template<typename T>
+        void RemoveComponent(Entity entity) {
+            if(!HasComponent<T>(entity)) {
+                return;
+            }
+
+            moveEntity(entity, archetypes[records[entity.index].archetype].mask & ~(1ull << componentId<T>()));
+        }
+
+        /**
+         * @brief Get component for reading
+         * 
+         * @param entity
+         * @return const T* nullptr when entity doesn't have component
+         */
+        template<typename T>
+        const T* GetComponent(Entity entity) {
+            if(!HasComponent<T>(entity)) {
+                return nullptr;
+            }
+
+            const EntityRecord& record = records[entity.index];
+            Archetype& archetype = archetypes[record.archetype];
+
+            return reinterpret_cast<const T*>(componentOf(archetype, archetype.chunks[record.chunk], archetype.column(componentId<T>()), record.row));
+        }
+
+        /**
+         * @brief Write component and mark it changed
+         * 
+         * @param entity
+         * @param component
+         */
+        template<typename T>
+        void SetComponent(Entity entity, const T& component) {
+            if(!HasComponent<T>(entity)) {
+                return;
+            }
+
+            writeComponent(records[entity.index], component);
+        }
+
+        /**
+         * @brief Call func(Entity, Ts&...) for every entity having all Ts,
+         * non-const Ts are marked changed in visited chunks
+         * 
+         * @param func
+         */
+        template<typename... Ts, typename F>
+        void ForEach(F&& func) {
+            uint64_t mask = queryMask<Ts...>();
+
+            for(Archetype& archetype : archetypes) {
+                if((archetype.mask & mask) != mask) {
+                    continue;
+                }
+
+                for(EcsChunk& chunk : archetype.chunks) {
+                    runChunk<Ts...>(archetype, chunk, func, std::index_sequence_for<Ts...>{});
+                }
+            }
+        }
+
+        /**
+         * @brief ForEach split by chunks between pool threads
+         * 
+         * @param pool
+         * @param func must be safe to call concurrently, may write only components of given entity
+         */
+        template<typename... Ts, typename F>
+        void ParallelForEach(JobPool* pool, F&& func) {
+            uint64_t mask = queryMask<Ts...>();
+
+            std::vector<std::pair<uint32_t, uint32_t>> chunks;
+
+            for(uint32_t a = 0; a < archetypes.size(); a++) {
+                if((archetypes[a].mask & mask) != mask) {
+                    continue;
+                }
+
+                for(uint32_t c = 0; c < archetypes[a].chunks.size(); c++) {
+                    chunks.push_back({a, c});
+                }
+            }
+
+            pool->ParallelFor(chunks.size(), [&](uint32_t i) {
+                Archetype& archetype = archetypes[chunks[i].first];
+
+                runChunk<Ts...>(archetype, archetype.chunks[chunks[i].second], func, std::index_sequence_for<Ts...>{});
+            });
+        }
+
+        /**
+         * @brief Call func(const Entity*, const T*, count) for every chunk whose T column was written after sinceVersion
+         * 
+         * @param sinceVersion version returned by earlier NextVersion (0 for all)
+         * @param func
+         */
+        template<typename T, typename F>
+        void ForEachChangedChunk(uint64_t sinceVersion, F&& func) {
+            uint32_t component = componentId<T>();
+
+            for(Archetype& archetype : archetypes) {
+                int column = archetype.column(component);
+
+                if(column < 0) {
+                    continue;
+                }
+
+                for(EcsChunk& chunk : archetype.chunks) {
+                    if(chunk.versions[column] <= sinceVersion) {
+                        continue;
+                    }
+
+                    func(entitiesOf(chunk), reinterpret_cast<const T*>(chunk.data.get() + archetype.offsets[column]), chunk.count);
+                }
+            }
+        }
+
+        /**
+         * @brief Call func(uint32_t entityIndex) for every entity that lost T (destroyed or T removed) after sinceVersion.
+         * Entity may have got T again later, so apply removals before changed chunks
+         * 
+         * @param sinceVersion version returned by earlier NextVersion (0 for all)
+         * @param func
+         * @return bool false when removals after sinceVersion were already forgotten (func isn't called)
+         */
+        template<typename T, typename F>
+        bool ForEachRemoved(uint64_t sinceVersion, F&& func) {
+            if(sinceVersion < trimmedVersion) {
+                return false;
+            }
+
+            uint64_t bit = 1ull << componentId<T>();
+
+            for(auto removal = removals.rbegin(); removal != removals.rend() && removal->version > sinceVersion; removal++) {
+                if(removal->mask & bit) {
+                    func(removal->index);
+                }
+            }
+
+            return true;
+        }
+
+        /**
+         * @brief Close current change version, later writes get newer one. Forgets removals older than ecsRemovalHistory versions
+         * 
+         * @return uint64_t closed version, every write so far is at or below it
+         */
+        uint64_t NextVersion() {
+            while(!removals.empty() && removals.front().version + ecsRemovalHistory <= version) {
+                trimmedVersion = removals.front().version;
+                removals.pop_front();
+            }
+
+            return version++;
+        }
+
+        /**
+         * @brief Get the Entities Count
+         * 
+         * @return uint32_t
+         */
+        uint32_t getEntitiesCount() { return records.size() - freeIndices.size(); }
+
+        /**
+         * @brief Get the Archetypes Count
+         * 
+         * @return uint32_t
+         */
+        uint32_t getArchetypesCount() { return archetypes.size(); }
+    };
+
+    typedef Vg_World World;
+
+    /**
+     * @brief GPU copy of one component, indexed by entity index, one host-visible buffer per frame in flight
+     * 
+     * Upload writes only chunks changed since same frame buffer was last uploaded and zeroes slots
+     * of entities that lost the component, so static scene costs nothing per frame.
+     */
+    template<typename T>
+    class Vg_SceneBuffer {
+    private:
+        // Memory stays mapped until it's freed, freeing unmaps it
+        std::vector<DeviceMemoryHandle> memories;
+        std::vector<BufferHandle> buffers;
+        std::vector<T*> mapped;
+        std::vector<uint64_t> uploadedVersions;
+
+        uint32_t maxEntities = 0;
+        uint32_t skippedCount = 0;
+        bool skippedWarned = false;
+
+        Device* pDevice = nullptr;
+
+    public:
+        /**
+         * @brief Create storage buffers
+         * 
+         * @param _pDevice pointer to created Device
+         * @param _maxEntities entities with bigger index are skipped (with warning)
+         * @param framesInFlight
+         */
+        void CreateSceneBuffer(Device* _pDevice, uint32_t _maxEntities, uint32_t framesInFlight) {
+            pDevice = _pDevice;
+            maxEntities = _maxEntities;
+
+            buffers.clear();
+            memories.clear();
+            buffers.resize(framesInFlight);
+            memories.resize(framesInFlight);
+            mapped.resize(framesInFlight);
+            uploadedVersions.assign(framesInFlight, 0);
+
+            for(uint32_t i = 0; i < framesInFlight; i++) {
+                pDevice->CreateBuffer(sizeof(T) * maxEntities, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, buffers[i], memories[i]);
+
+                if(vkMapMemory(*pDevice->getLogicalDevicePtr(), memories[i].get(), 0, VK_WHOLE_SIZE, 0, (void**)&mapped[i]) != VK_SUCCESS) {
+                    std::cerr << "Cannot map scene buffer memory!\n";
+
+                    VG_PROFILE_EXIT(33);
+                    exit(33);
+                }
+            }
+        }
+
+        /**
+         * @brief Copy components changed since last upload of frame, call after systems ran
+         * 
+         * @param world
+         * @param frameIndex
+         * @return uint32_t uploaded components count
+         */
+        uint32_t Upload(World* world, uint32_t frameIndex) {
+            uint64_t closedVersion = world->NextVersion();
+            uint64_t sinceVersion = uploadedVersions[frameIndex];
+            uint32_t uploaded = 0;
+
+            T* target = mapped[frameIndex];
+
+            // Buffer content is unknown on first upload and stale slots can't be found after removals were forgotten
+            bool cleared = sinceVersion == 0 || !world->template ForEachRemoved<T>(sinceVersion, [&](uint32_t index) {
+                if(index < maxEntities) {
+                    target[index] = T{};
+                }
+            });
+
+            if(cleared) {
+                memset(target, 0, sizeof(T) * maxEntities);
+                sinceVersion = 0;
+            }
+
+            skippedCount = 0;
+
+            world->ForEachChangedChunk<T>(sinceVersion, [&](const Entity* entities, const T* components, uint32_t count) {
+                for(uint32_t i = 0; i < count; i++) {
+                    if(entities[i].index < maxEntities) {
+                        target[entities[i].index] = components[i];
+                        uploaded++;
+                    }
+                    else {
+                        skippedCount++;
+                    }
+                }
+            });
+
+            if(skippedCount > 0 && !skippedWarned) {
+                std::cerr << "Entity index is bigger than scene buffer capacity, its component is not uploaded!\n";
+
+                skippedWarned = true;
+            }
+
+            uploadedVersions[frameIndex] = closedVersion;
+
+            return uploaded;
+        }
+
+        /**
+         * @brief Get number of changed components skipped in last Upload because entity index was at least maxEntities
+         * 
+         * @return uint32_t 
+         */
+        uint32_t getSkippedCount() { return skippedCount; }
+
+        /**
+         * @brief Get the Buffer Ptr of frame
+         * 
+         * @param frameIndex
+         * @return const VkBuffer*
+         */
+        const VkBuffer* getBufferPtr(uint32_t frameIndex) { return buffers[frameIndex].getPtr(); }
+
+        /**
+         * @brief Get the Max Entities
+         * 
+         * @return uint32_t
+         */
+        uint32_t getMaxEntities() { return maxEntities; }
+    };
+
+    typedef Vg_SceneBuffer<Transform> TransformBuffer;
+    typedef Vg_SceneBuffer<Material> MaterialBuffer;
+}
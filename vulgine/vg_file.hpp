@@ -0,0 +1,220 @@
+#pragma once
+#define VG_FILE 1
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <cstdint>
+#include <utility>
+
+#ifndef VG_PROFILER
+#include "vg_profiler.hpp"
+#endif
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace vg {
+    /**
+     * @brief Read whole binary file (eg. SPIR-V shader)
+     * 
+     * @param path path to file
+     * @return std::vector<char> 
+     */
+    inline std::vector<char> readFile(const std::string& path) {
+        std::ifstream file(path, std::ios::ate | std::ios::binary);
+
+        if(!file.is_open()) {
+            std::cerr << "Cannot open file " << path << "!\n";
+
+            VG_PROFILE_EXIT(17);
+            exit(17);
+        }
+
+        size_t size = (size_t)file.tellg();
+        std::vector<char> buffer(size);
+
+        file.seekg(0);
+        file.read(buffer.data(), size);
+
+        return buffer;
+    }
+
+    /**
+     * @brief Read-only memory mapped file, data is paged in by OS on first access
+     * 
+     */
+    class Vg_MappedFile {
+    private:
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+
+    #ifdef _WIN32
+        HANDLE file = INVALID_HANDLE_VALUE;
+        HANDLE mapping = nullptr;
+    #else
+        int fd = -1;
+    #endif
+
+    public:
+        Vg_MappedFile() = default;
+        Vg_MappedFile(const Vg_MappedFile&) = delete;
+        Vg_MappedFile& operator=(const Vg_MappedFile&) = delete;
+
+        Vg_MappedFile(Vg_MappedFile&& other) noexcept {
+            swap(other);
+        }
+
+        Vg_MappedFile& operator=(Vg_MappedFile&& other) noexcept {
+            if(this != &other) {
+                Close();
+                swap(other);
+            }
+
+            return *this;
+        }
+
+        /**
+         * @brief Exchange mappings with other file
+         * 
+         * @param other 
+         */
+        void swap(Vg_MappedFile& other) noexcept {
+            std::swap(data, other.data);
+            std::swap(size, other.size);
+
+        #ifdef _WIN32
+            std::swap(file, other.file);
+            std::swap(mapping, other.mapping);
+        #else
+            std::swap(fd, other.fd);
+        #endif
+        }
+
+        /**
+         * @brief Map whole file to memory
+         * 
+         * @param path path to file
+         * @return int 0 on success, 1 when file cannot be opened, 2 when it cannot be mapped
+         */
+        int Open(const std::string& path) {
+            Close();
+
+        #ifdef _WIN32
+            file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+            if(file == INVALID_HANDLE_VALUE) {
+                std::cerr << "Cannot open file " << path << "!\n";
+
+                return 1;
+            }
+
+            LARGE_INTEGER fileSize;
+            GetFileSizeEx(file, &fileSize);
+            size = (size_t)fileSize.QuadPart;
+
+            mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+            if(mapping != nullptr) {
+                data = (const uint8_t*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            }
+        #else
+            fd = open(path.c_str(), O_RDONLY);
+
+            if(fd < 0) {
+                std::cerr << "Cannot open file " << path << "!\n";
+
+                return 1;
+            }
+
+            struct stat fileStat;
+            fstat(fd, &fileStat);
+            size = (size_t)fileStat.st_size;
+
+            if(size > 0) {
+                void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+                if(mapped != MAP_FAILED) {
+                    data = (const uint8_t*)mapped;
+                }
+            }
+        #endif
+
+            if(data == nullptr) {
+                std::cerr << "Cannot map file " << path << "!\n";
+
+                Close();
+
+                return 2;
+            }
+
+            return 0;
+        }
+
+        /**
+         * @brief Unmap and close file
+         * 
+         */
+        void Close() {
+        #ifdef _WIN32
+            if(data != nullptr) {
+                UnmapViewOfFile(data);
+            }
+
+            if(mapping != nullptr) {
+                CloseHandle(mapping);
+            }
+
+            if(file != INVALID_HANDLE_VALUE) {
+                CloseHandle(file);
+            }
+
+            mapping = nullptr;
+            file = INVALID_HANDLE_VALUE;
+        #else
+            if(data != nullptr) {
+                munmap((void*)data, size);
+            }
+
+            if(fd >= 0) {
+                close(fd);
+            }
+
+            fd = -1;
+        #endif
+
+            data = nullptr;
+            size = 0;
+        }
+
+        /**
+         * @brief Get pointer to mapped file content
+         * 
+         * @return const uint8_t* 
+         */
+        const uint8_t* getData() const { return data; }
+
+        /**
+         * @brief Get size of mapped file in bytes
+         * 
+         * @return size_t 
+         */
+        size_t getSize() const { return size; }
+
+        ~Vg_MappedFile() {
+            Close();
+        }
+    };
+
+    typedef Vg_MappedFile MappedFile;
+}
@@ -0,0 +1,173 @@
+#pragma once
+#define VG_HANDLE 1
+
+#include <vulkan/vulkan.hpp>
+#include <type_traits>
+#include <utility>
+
+namespace vg {
+    /**
+     * @brief Move-only owner of Vulkan handle, destroys it with Deleter when going out of scope
+     * 
+     * Deleter is empty base, so handle with stateless deleter (InstanceDeleter, DeviceDeleter) has size of raw handle,
+     * device/instance children carry parent handle needed to destroy them, so they are twice the size of raw handle
+     * on 64-bit (eg. 16 bytes per element in std::vector<SemaphoreHandle>).
+     * Copy is deleted, so second owner of same handle is compile error, transfer needs std::move or release().
+     */
+    template<typename T, typename Deleter>
+    class Handle : private Deleter {
+        static_assert(std::is_invocable<const Deleter&, T>::value, "Deleter must be callable with handle");
+
+    private:
+        T handle = T();
+
+    public:
+        Handle() = default;
+
+        /**
+         * @brief Take ownership of created handle
+         * 
+         * @param _handle
+         * @param deleter eg. {device} for device children
+         */
+        explicit Handle(T _handle, const Deleter& deleter = Deleter()) : Deleter(deleter), handle(_handle) {}
+
+        Handle(const Handle&) = delete;
+        Handle& operator=(const Handle&) = delete;
+
+        Handle(Handle&& other) noexcept : Deleter(std::move(static_cast<Deleter&>(other))), handle(other.release()) {}
+
+        Handle& operator=(Handle&& other) noexcept {
+            if(this != &other) {
+                reset();
+
+                static_cast<Deleter&>(*this) = std::move(static_cast<Deleter&>(other));
+                handle = other.release();
+            }
+
+            return *this;
+        }
+
+        /**
+         * @brief Get raw handle, ownership stays in Handle
+         * 
+         * @return T
+         */
+        T get() const { return handle; }
+
+        /**
+         * @brief Get pointer to raw handle for Vulkan structs taking arrays (eg. VkPresentInfoKHR::pSwapchains)
+         * 
+         * @return const T*
+         */
+        const T* getPtr() const { return &handle; }
+
+        /**
+         * @brief Destroy owned handle and return address for vkCreate* output
+         * 
+         * @param deleter eg. {device} for device children
+         * @return T*
+         */
+        T* put(const Deleter& deleter = Deleter()) {
+            reset();
+
+            static_cast<Deleter&>(*this) = deleter;
+
+            return &handle;
+        }
+
+        /**
+         * @brief Destroy owned handle, does nothing when empty
+         * 
+         */
+        void reset() {
+            if(handle != T()) {
+                static_cast<const Deleter&>(*this)(handle);
+
+                handle = T();
+            }
+        }
+
+        /**
+         * @brief Give up ownership without destroying
+         * 
+         * @return T
+         */
+        [[nodiscard]] T release() {
+            T released = handle;
+            handle = T();
+
+            return released;
+        }
+
+        explicit operator bool() const { return handle != T(); }
+
+        ~Handle() {
+            reset();
+        }
+    };
+
+    struct InstanceDeleter {
+        void operator()(VkInstance instance) const { vkDestroyInstance(instance, nullptr); }
+    };
+
+    struct DeviceDeleter {
+        void operator()(VkDevice device) const { vkDestroyDevice(device, nullptr); }
+    };
+
+    template<typename T, auto Destroy>
+    struct InstanceChildDeleter {
+        VkInstance instance = VK_NULL_HANDLE;
+
+        void operator()(T handle) const { Destroy(instance, handle, nullptr); }
+    };
+
+    template<typename T, auto Destroy>
+    struct DeviceChildDeleter {
+        VkDevice device = VK_NULL_HANDLE;
+
+        void operator()(T handle) const { Destroy(device, handle, nullptr); }
+    };
+
+    struct DebugMessengerDeleter {
+        VkInstance instance = VK_NULL_HANDLE;
+
+        void operator()(VkDebugUtilsMessengerEXT messenger) const {
+            auto func = (PFN_vkDestroyDebugUtilsMessengerEXT)vkGetInstanceProcAddr(instance, "vkDestroyDebugUtilsMessengerEXT");
+
+            if(func != nullptr) {
+                func(instance, messenger, nullptr);
+            }
+        }
+    };
+
+    typedef Handle<VkInstance, InstanceDeleter> InstanceHandle;
+    typedef Handle<VkDevice, DeviceDeleter> DeviceHandle;
+    typedef Handle<VkSurfaceKHR, InstanceChildDeleter<VkSurfaceKHR, vkDestroySurfaceKHR>> SurfaceHandle;
+    typedef Handle<VkDebugUtilsMessengerEXT, DebugMessengerDeleter> DebugMessengerHandle;
+
+    // Children carry their parent (instance or device) for destruction, so they take two raw handles of space
+    typedef Handle<VkSwapchainKHR, DeviceChildDeleter<VkSwapchainKHR, vkDestroySwapchainKHR>> SwapchainHandle;
+    typedef Handle<VkBuffer, DeviceChildDeleter<VkBuffer, vkDestroyBuffer>> BufferHandle;
+    typedef Handle<VkDeviceMemory, DeviceChildDeleter<VkDeviceMemory, vkFreeMemory>> DeviceMemoryHandle;
+    typedef Handle<VkImage, DeviceChildDeleter<VkImage, vkDestroyImage>> ImageHandle;
+    typedef Handle<VkImageView, DeviceChildDeleter<VkImageView, vkDestroyImageView>> ImageViewHandle;
+    typedef Handle<VkSampler, DeviceChildDeleter<VkSampler, vkDestroySampler>> SamplerHandle;
+    typedef Handle<VkRenderPass, DeviceChildDeleter<VkRenderPass, vkDestroyRenderPass>> RenderPassHandle;
+    typedef Handle<VkFramebuffer, DeviceChildDeleter<VkFramebuffer, vkDestroyFramebuffer>> FramebufferHandle;
+    typedef Handle<VkShaderModule, DeviceChildDeleter<VkShaderModule, vkDestroyShaderModule>> ShaderModuleHandle;
+    typedef Handle<VkPipeline, DeviceChildDeleter<VkPipeline, vkDestroyPipeline>> PipelineHandle;
+    typedef Handle<VkPipelineLayout, DeviceChildDeleter<VkPipelineLayout, vkDestroyPipelineLayout>> PipelineLayoutHandle;
+    typedef Handle<VkDescriptorSetLayout, DeviceChildDeleter<VkDescriptorSetLayout, vkDestroyDescriptorSetLayout>> DescriptorSetLayoutHandle;
+    typedef Handle<VkDescriptorPool, DeviceChildDeleter<VkDescriptorPool, vkDestroyDescriptorPool>> DescriptorPoolHandle;
+    typedef Handle<VkCommandPool, DeviceChildDeleter<VkCommandPool, vkDestroyCommandPool>> CommandPoolHandle;
+    typedef Handle<VkSemaphore, DeviceChildDeleter<VkSemaphore, vkDestroySemaphore>> SemaphoreHandle;
+    typedef Handle<VkFence, DeviceChildDeleter<VkFence, vkDestroyFence>> FenceHandle;
+
+    static_assert(sizeof(InstanceHandle) == sizeof(VkInstance), "Handle with stateless deleter must have size of raw handle");
+    static_assert(sizeof(DeviceHandle) == sizeof(VkDevice), "Handle with stateless deleter must have size of raw handle");
+    static_assert(sizeof(SurfaceHandle) == 2 * sizeof(VkSurfaceKHR), "Instance child handle must be raw handle and its instance");
+    static_assert(sizeof(BufferHandle) == 2 * sizeof(VkBuffer), "Device child handle must be raw handle and its device");
+    static_assert(sizeof(SemaphoreHandle) == 2 * sizeof(VkSemaphore), "Device child handle must be raw handle and its device");
+    static_assert(std::is_nothrow_move_constructible<ImageViewHandle>::value && !std::is_copy_constructible<ImageViewHandle>::value, "Handles must be move-only");
+}
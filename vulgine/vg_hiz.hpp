@@ -0,0 +1,443 @@
+#pragma once
+#define VG_HIZ 1
+
+#ifndef VG_SWAPCHAIN
+#include "vg_swapchain.hpp"
+#endif
+
+#ifndef VG_DRAW_BATCH
+#include "vg_draw_batch.hpp"
+#endif
+
+#ifndef VG_COMPUTE
+#include "vg_compute.hpp"
+#endif
+
+#include <array>
+#include <cmath>
+#include <cstring>
+
+namespace vg {
+    /**
+     * @brief Hierarchical-Z occlusion culling, builds min/max depth pyramid from previous frame depth
+     * and zeroes instanceCount of occluded draws in device-local Vg_DrawBatcher indirect buffer of the frame
+     * 
+     */
+    class Vg_HiZ {
+    private:
+        struct BuildParams {
+            int32_t sourceSize[2];
+            int32_t destinationSize[2];
+            int32_t firstLevel;
+        };
+
+        struct CullParams {
+            float viewProj[16];
+            float pyramidSize[2];
+            uint32_t drawCount;
+            uint32_t levelCount;
+        };
+
+        Device* pDevice = nullptr;
+        Swapchain* pSwapchain = nullptr;
+        DrawBatcher* pBatcher = nullptr;
+
+        // Members are destroyed in reverse order, so views go before their image and pipelines before set layouts
+        DescriptorSetLayoutHandle buildSetLayout;
+        DescriptorSetLayoutHandle cullSetLayout;
+
+        ComputePipeline buildPipeline;
+        ComputePipeline cullPipeline;
+
+        SamplerHandle sampler;
+        DescriptorPoolHandle descriptorPool;
+        std::vector<VkDescriptorSet> buildSets;
+        std::vector<VkDescriptorSet> cullSets;
+
+        DeviceMemoryHandle pyramidMemory;
+        ImageHandle pyramidImage;
+        ImageViewHandle pyramidView;
+        std::vector<ImageViewHandle> levelViews;
+        VkExtent2D pyramidExtent;
+        uint32_t levelCount = 0;
+
+        bool depthValid = false;
+        bool pyramidValid = false;
+        bool prevViewProjValid = false;
+        float prevViewProj[16];
+
+        DescriptorSetLayoutHandle createSetLayout(const std::vector<VkDescriptorType>& types) {
+            std::vector<VkDescriptorSetLayoutBinding> bindings(types.size());
+
+            for(uint32_t i = 0; i < types.size(); i++) {
+                bindings[i] = {};
+                bindings[i].binding = i;
+                bindings[i].descriptorType = types[i];
+                bindings[i].descriptorCount = 1;
+                bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+            }
+
+            VkDescriptorSetLayoutCreateInfo layoutInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
+            layoutInfo.bindingCount = bindings.size();
+            layoutInfo.pBindings = bindings.data();
+
+            DescriptorSetLayoutHandle layout;
+
+            if(vkCreateDescriptorSetLayout(*pDevice->getLogicalDevicePtr(), &layoutInfo, nullptr, layout.put({*pDevice->getLogicalDevicePtr()})) != VK_SUCCESS) {
+                std::cerr << "Cannot create descriptor set layout!\n";
+
+                VG_PROFILE_EXIT(21);
+                exit(21);
+            }
+
+            return layout;
+        }
+
+        void createPyramid() {
+            VkDevice device = *pDevice->getLogicalDevicePtr();
+            uint32_t framesInFlight = pBatcher->getFramesInFlight();
+
+            VkExtent2D depthExtent = pSwapchain->getExtent();
+
+            pyramidExtent = depthExtent;
+            levelCount = (uint32_t)std::floor(std::log2((double)std::max(depthExtent.width, depthExtent.height))) + 1;
+
+            pDevice->CreateImage(pyramidExtent.width, pyramidExtent.height, levelCount, 1, VK_FORMAT_R32G32_SFLOAT, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, pyramidImage, pyramidMemory);
+
+            pyramidView = ImageViewHandle(pDevice->CreateImageView(pyramidImage.get(), VK_FORMAT_R32G32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT, 0, levelCount), {device});
+
+            levelViews.clear();
+
+            for(uint32_t i = 0; i < levelCount; i++) {
+                levelViews.push_back(ImageViewHandle(pDevice->CreateImageView(pyramidImage.get(), VK_FORMAT_R32G32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT, i, 1), {device}));
+            }
+
+            std::array<VkDescriptorPoolSize, 3> poolSizes{};
+            poolSizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            poolSizes[0].descriptorCount = levelCount + framesInFlight;
+            poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+            poolSizes[1].descriptorCount = levelCount;
+            poolSizes[2].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            poolSizes[2].descriptorCount = 2 * framesInFlight;
+
+            VkDescriptorPoolCreateInfo poolInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
+            poolInfo.maxSets = levelCount + framesInFlight;
+            poolInfo.poolSizeCount = poolSizes.size();
+            poolInfo.pPoolSizes = poolSizes.data();
+
+            if(vkCreateDescriptorPool(device, &poolInfo, nullptr, descriptorPool.put({device})) != VK_SUCCESS) {
+                std::cerr << "Cannot create descriptor pool!\n";
+
+                VG_PROFILE_EXIT(22);
+                exit(22);
+            }
+
+            std::vector<VkDescriptorSetLayout> layouts(levelCount, buildSetLayout.get());
+            layouts.insert(layouts.end(), framesInFlight, cullSetLayout.get());
+
+            std::vector<VkDescriptorSet> sets(layouts.size());
+
+            VkDescriptorSetAllocateInfo allocInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
+            allocInfo.descriptorPool = descriptorPool.get();
+            allocInfo.descriptorSetCount = layouts.size();
+            allocInfo.pSetLayouts = layouts.data();
+
+            if(vkAllocateDescriptorSets(device, &allocInfo, sets.data()) != VK_SUCCESS) {
+                std::cerr << "Cannot allocate descriptor sets!\n";
+
+                VG_PROFILE_EXIT(23);
+                exit(23);
+            }
+
+            buildSets.assign(sets.begin(), sets.begin() + levelCount);
+            cullSets.assign(sets.begin() + levelCount, sets.end());
+
+            std::vector<VkDescriptorImageInfo> imageInfos(levelCount * 2 + 1);
+            std::vector<VkDescriptorBufferInfo> bufferInfos(framesInFlight * 2);
+            std::vector<VkWriteDescriptorSet> writes;
+
+            for(uint32_t i = 0; i < levelCount; i++) {
+                VkDescriptorImageInfo& source = imageInfos[i * 2];
+                source.sampler = sampler.get();
+                source.imageView = i == 0 ? *pSwapchain->getDepthViewPtr() : levelViews[i - 1].get();
+                source.imageLayout = i == 0 ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_GENERAL;
+
+                VkDescriptorImageInfo& destination = imageInfos[i * 2 + 1];
+                destination.imageView = levelViews[i].get();
+                destination.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+                VkWriteDescriptorSet write{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+                write.dstSet = buildSets[i];
+                write.descriptorCount = 1;
+
+                write.dstBinding = 0;
+                write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+                write.pImageInfo = &source;
+                writes.push_back(write);
+
+                write.dstBinding = 1;
+                write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+                write.pImageInfo = &destination;
+                writes.push_back(write);
+            }
+
+            VkDescriptorImageInfo& pyramidInfo = imageInfos.back();
+            pyramidInfo.sampler = sampler.get();
+            pyramidInfo.imageView = pyramidView.get();
+            pyramidInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+            // Every frame in flight culls its own batcher buffers
+            for(uint32_t f = 0; f < framesInFlight; f++) {
+                bufferInfos[f * 2].buffer = *pBatcher->getBoundsBufferPtr(f);
+                bufferInfos[f * 2].range = VK_WHOLE_SIZE;
+                bufferInfos[f * 2 + 1].buffer = *pBatcher->getIndirectBufferPtr(f);
+                bufferInfos[f * 2 + 1].range = VK_WHOLE_SIZE;
+
+                VkWriteDescriptorSet write{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+                write.dstSet = cullSets[f];
+                write.descriptorCount = 1;
+
+                write.dstBinding = 0;
+                write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+                write.pImageInfo = &pyramidInfo;
+                writes.push_back(write);
+
+                write.pImageInfo = nullptr;
+                write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+
+                write.dstBinding = 1;
+                write.pBufferInfo = &bufferInfos[f * 2];
+                writes.push_back(write);
+
+                write.dstBinding = 2;
+                write.pBufferInfo = &bufferInfos[f * 2 + 1];
+                writes.push_back(write);
+            }
+
+            vkUpdateDescriptorSets(device, writes.size(), writes.data(), 0, nullptr);
+
+            depthValid = false;
+            pyramidValid = false;
+        }
+
+        void destroyPyramid() {
+            descriptorPool.reset();
+            buildSets.clear();
+            cullSets.clear();
+
+            levelViews.clear();
+            pyramidView.reset();
+            pyramidImage.reset();
+            pyramidMemory.reset();
+        }
+
+        void depthBarrier(VkCommandBuffer commandBuffer, VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccess, VkAccessFlags dstAccess, VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage) {
+            VkFormat depthFormat = pSwapchain->getDepthFormat();
+
+            VkImageMemoryBarrier barrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+            barrier.oldLayout = oldLayout;
+            barrier.newLayout = newLayout;
+            barrier.srcAccessMask = srcAccess;
+            barrier.dstAccessMask = dstAccess;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.image = *pSwapchain->getDepthImagePtr();
+            barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+            barrier.subresourceRange.levelCount = 1;
+            barrier.subresourceRange.layerCount = 1;
+
+            if(depthFormat == VK_FORMAT_D32_SFLOAT_S8_UINT || depthFormat == VK_FORMAT_D24_UNORM_S8_UINT) {
+                barrier.subresourceRange.aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
+            }
+
+            vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+        }
+
+        void memoryBarrier(VkCommandBuffer commandBuffer, VkAccessFlags srcAccess, VkAccessFlags dstAccess, VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage) {
+            VkMemoryBarrier barrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+            barrier.srcAccessMask = srcAccess;
+            barrier.dstAccessMask = dstAccess;
+
+            vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+        }
+
+    public:
+        /**
+         * @brief Create HiZ pipelines and depth pyramid. Swapchain must be created with setKeepDepth(true) and have depth resources
+         * 
+         * @param _pDevice pointer to created Device, needs shaderStorageImageExtendedFormats and rg32f storage image support
+         * @param _pSwapchain swapchain which depth is used
+         * @param _pBatcher draw batcher which indirect commands are culled, created with setGpuCulling(true)
+         * @param buildShaderPath compiled shaders/hiz_build.comp
+         * @param cullShaderPath compiled shaders/hiz_cull.comp
+         */
+        void CreateHiZ(Device* _pDevice, Swapchain* _pSwapchain, DrawBatcher* _pBatcher, const std::string& buildShaderPath = "vulgine/shaders/hiz_build.comp.spv", const std::string& cullShaderPath = "vulgine/shaders/hiz_cull.comp.spv") {
+            pDevice = _pDevice;
+            pSwapchain = _pSwapchain;
+            pBatcher = _pBatcher;
+
+            if(!pBatcher->isGpuCullingEnabled()) {
+                std::cerr << "Draw batcher must be created with GPU culling for HiZ!\n";
+
+                VG_PROFILE_EXIT(29);
+                exit(29);
+            }
+
+            VkFormatProperties pyramidFormatProperties;
+            vkGetPhysicalDeviceFormatProperties(*pDevice->getPhysicalDevicePtr(), VK_FORMAT_R32G32_SFLOAT, &pyramidFormatProperties);
+
+            if(!pDevice->isStorageImageExtendedFormatsEnabled() || !(pyramidFormatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT)) {
+                std::cerr << "Device doesn't support rg32f storage images needed by HiZ!\n";
+
+                VG_PROFILE_EXIT(31);
+                exit(31);
+            }
+
+            buildSetLayout = createSetLayout({VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE});
+            cullSetLayout = createSetLayout({VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER});
+
+            buildPipeline.CreateComputePipeline(pDevice, buildShaderPath, {buildSetLayout.get()}, sizeof(BuildParams));
+            cullPipeline.CreateComputePipeline(pDevice, cullShaderPath, {cullSetLayout.get()}, sizeof(CullParams));
+
+            VkSamplerCreateInfo samplerInfo{VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO};
+            samplerInfo.magFilter = VK_FILTER_NEAREST;
+            samplerInfo.minFilter = VK_FILTER_NEAREST;
+            samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+            samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+            samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+            samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+            samplerInfo.minLod = 0.0f;
+            samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+
+            if(vkCreateSampler(*pDevice->getLogicalDevicePtr(), &samplerInfo, nullptr, sampler.put({*pDevice->getLogicalDevicePtr()})) != VK_SUCCESS) {
+                std::cerr << "Cannot create sampler!\n";
+
+                VG_PROFILE_EXIT(24);
+                exit(24);
+            }
+
+            createPyramid();
+        }
+
+        /**
+         * @brief Recreate depth pyramid after swapchain was recreated (device must be idle)
+         * 
+         */
+        void Resize() {
+            destroyPyramid();
+            createPyramid();
+        }
+
+        /**
+         * @brief Record depth pyramid build from depth of previous frame, call before render pass.
+         * In first frame there is no depth yet, so only pyramid layout is prepared
+         * 
+         * @param commandBuffer command buffer outside of render pass
+         */
+        void RecordBuild(VkCommandBuffer commandBuffer) {
+            if(!depthValid) {
+                VkImageMemoryBarrier barrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+                barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+                barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+                barrier.srcAccessMask = 0;
+                barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+                barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.image = pyramidImage.get();
+                barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+                barrier.subresourceRange.levelCount = levelCount;
+                barrier.subresourceRange.layerCount = 1;
+
+                vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+                depthValid = true;
+
+                return;
+            }
+
+            depthBarrier(commandBuffer, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+                VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+            // Previous frame culling still may read pyramid
+            memoryBarrier(commandBuffer, VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+            buildPipeline.Bind(commandBuffer);
+
+            VkExtent2D sourceExtent = pyramidExtent;
+
+            for(uint32_t i = 0; i < levelCount; i++) {
+                VkExtent2D levelExtent = {std::max(pyramidExtent.width >> i, 1u), std::max(pyramidExtent.height >> i, 1u)};
+
+                BuildParams params{};
+                params.sourceSize[0] = sourceExtent.width;
+                params.sourceSize[1] = sourceExtent.height;
+                params.destinationSize[0] = levelExtent.width;
+                params.destinationSize[1] = levelExtent.height;
+                params.firstLevel = i == 0 ? 1 : 0;
+
+                vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, *buildPipeline.getPipelineLayoutPtr(), 0, 1, &buildSets[i], 0, nullptr);
+                vkCmdPushConstants(commandBuffer, *buildPipeline.getPipelineLayoutPtr(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(BuildParams), &params);
+                vkCmdDispatch(commandBuffer, (levelExtent.width + 7) / 8, (levelExtent.height + 7) / 8, 1);
+
+                memoryBarrier(commandBuffer, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+                sourceExtent = levelExtent;
+            }
+
+            depthBarrier(commandBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT);
+
+            pyramidValid = true;
+        }
+
+        /**
+         * @brief Record culling of batcher commands against depth pyramid, call after DrawBatcher::RecordUpload and RecordBuild
+         * 
+         * @param commandBuffer command buffer outside of render pass
+         * @param frameIndex index of frame in flight passed to DrawBatcher::Build
+         * @param viewProj column-major view-projection matrix of this frame, bounds are tested with matrix of previous frame
+         */
+        void RecordCull(VkCommandBuffer commandBuffer, uint32_t frameIndex, const float* viewProj) {
+            uint32_t drawCount = pBatcher->getCommandsCount();
+
+            // DrawBatcher::RecordUpload already made uploaded commands visible to this shader
+            if(pyramidValid && prevViewProjValid && drawCount > 0) {
+                CullParams params{};
+                memcpy(params.viewProj, prevViewProj, sizeof(prevViewProj));
+                params.pyramidSize[0] = (float)pyramidExtent.width;
+                params.pyramidSize[1] = (float)pyramidExtent.height;
+                params.drawCount = drawCount;
+                params.levelCount = levelCount;
+
+                cullPipeline.Bind(commandBuffer);
+
+                vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, *cullPipeline.getPipelineLayoutPtr(), 0, 1, &cullSets[frameIndex], 0, nullptr);
+                vkCmdPushConstants(commandBuffer, *cullPipeline.getPipelineLayoutPtr(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullParams), &params);
+                vkCmdDispatch(commandBuffer, (drawCount + 63) / 64, 1, 1);
+
+                memoryBarrier(commandBuffer, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT);
+            }
+
+            memcpy(prevViewProj, viewProj, sizeof(prevViewProj));
+            prevViewProjValid = true;
+        }
+
+        /**
+         * @brief Get number of depth pyramid levels
+         * 
+         * @return uint32_t
+         */
+        uint32_t getLevelCount() { return levelCount; }
+
+        /**
+         * @brief Get the Pyramid View Ptr (all levels, VK_IMAGE_LAYOUT_GENERAL)
+         * 
+         * @return const VkImageView*
+         */
+        const VkImageView* getPyramidViewPtr() { return pyramidView.getPtr(); }
+    };
+
+    typedef Vg_HiZ HiZ;
+}
@@ -3,6 +3,15 @@
 
 #include <vulkan/vulkan.hpp>
 #include <iostream>
+#include <cstring>
+
+#ifndef VG_PROFILER
+#include "vg_profiler.hpp"
+#endif
+
+#ifndef VG_HANDLE
+#include "vg_handle.hpp"
+#endif
 
 #ifdef NDEBUG
 const bool enableValidationLayers = false;
@@ -21,11 +30,11 @@ namespace vg {
      * 
      * @return std::vector<const char*> 
      */
-    std::vector<const char*> getExtensions() {
+    inline std::vector<const char*> getExtensions() {
         uint32_t count = 0;
         const char** extensions = glfwGetRequiredInstanceExtensions(&count);
 
-        std::vector<const char*> requiredExtensions(extension, extension + count);
+        std::vector<const char*> requiredExtensions(extensions, extensions + count);
 
         if(enableValidationLayers) {
             requiredExtensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
@@ -43,8 +52,12 @@ namespace vg {
 
     class Vg_Instance {
     private:
-        VkInstance _instance;
-        VkDebugUtilsMessengerEXT debugMessenger;
+        // Declared before its children, so it's destroyed after them
+        InstanceHandle _instance;
+        DebugMessengerHandle debugMessenger;
+        SurfaceHandle presentSurface;
+
+        uint32_t instanceApiVersion = VK_API_VERSION_1_0;
 
         bool checkValidationLayerSupport() {
             uint32_t count;
@@ -57,7 +70,7 @@ namespace vg {
                 bool layerFound = false;
 
                 for(const auto& layer : layerProp) {
-                    if(strcmp(layerName, layer.layerName)) {
+                    if(strcmp(layerName, layer.layerName) == 0) {
                         layerFound = true;
 
                         break;
@@ -88,20 +101,13 @@ namespace vg {
             auto func = (PFN_vkCreateDebugUtilsMessengerEXT)vkGetInstanceProcAddr(instance, "vkCreateDebugUtilsMessengerEXT");
 
             if(func != nullptr) {
-                func(instance, pCreateInfo, pAllocator, pDebugMessenger);
+                return func(instance, pCreateInfo, pAllocator, pDebugMessenger);
             }
-        }
 
-        void DestroyDebugUtilsMessengerEXT(VkInstance instance, VkDebugUtilsMessengerEXT debugMessenger, const VkAllocationCallbacks* pAllocator) {
-            auto func = (PFN_vkDestroyDebugUtilsMessengerEXT)vkGetInstanceProcAddr(instance, "vkDestroyDebugUtilsMessengerEXT");
-
-            if(func != nullptr) {
-                func(instance, debugMessenger, pAllocator);
-            }
+            return VK_ERROR_EXTENSION_NOT_PRESENT;
         }
 
     public:
-    VkSurfaceKHR presentSurface;
 
     #ifdef _glfw3_h_
         /**
@@ -113,6 +119,8 @@ namespace vg {
          * @return int 
          */
         int CreateInstance(GLFWwindow* window, std::vector<const char*> windowExtensions = getExtensions(), const char* appName = "Application", uint32_t apiVersion = VK_API_VERSION_1_2) {
+            VG_PROFILE_FUNCTION();
+
             if(enableValidationLayers && !checkValidationLayerSupport()) {
                 std::cerr << "Validation layers are unavailable!\n";
                 
@@ -145,12 +153,14 @@ namespace vg {
                 instInfo.enabledLayerCount = 0;
             }
 
-            if(vkCreateInstance(&instInfo, nullptr, &_instance) != VK_SUCCESS) {
+            if(vkCreateInstance(&instInfo, nullptr, _instance.put()) != VK_SUCCESS) {
                 std::cerr << "Cannot create vulkan instance!\n";
 
                 return 2;
             }
 
+            instanceApiVersion = apiVersion;
+
             uint32_t extensionCount = 0;
             vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
 
@@ -161,7 +171,7 @@ namespace vg {
                 VkDebugUtilsMessengerCreateInfoEXT debug{};
                 populateDebugMessengerCreateInfo(debug);
 
-                if(CreateDebugUtilsMessengerEXT(_instance, &debug, nullptr, &debugMessenger) != VK_SUCCESS) {
+                if(CreateDebugUtilsMessengerEXT(_instance.get(), &debug, nullptr, debugMessenger.put({_instance.get()})) != VK_SUCCESS) {
                     std::cerr << "Cannot create debug messenger!\n";
 
                     return 3;
@@ -169,6 +179,8 @@ namespace vg {
             }
 
             CreateGLFWPresentSurface(window);
+
+            return 0;
         }
 
         /**
@@ -176,10 +188,13 @@ namespace vg {
          * 
          * @param window 
          */
-        void CreateGLFWPresentSurface(GLFWwindow* window, ) {
-            if(glfwCreateWindowSurface(_instance, window, nullptr, &presentSurface) != VK_SUCCESS) {
+        void CreateGLFWPresentSurface(GLFWwindow* window) {
+            VG_PROFILE_FUNCTION();
+
+            if(glfwCreateWindowSurface(_instance.get(), window, nullptr, presentSurface.put({_instance.get()})) != VK_SUCCESS) {
                 std::cerr << "Cannot create GLFW present surface!\n";
 
+                VG_PROFILE_EXIT(4);
                 exit(4);
             }
         }
@@ -193,6 +208,8 @@ namespace vg {
          * @return int 
          */
         int CreateInstance(std::vector<const char*> windowExtensions, const char* appName = "Application", uint32_t apiVersion = VK_API_VERSION_1_2) {
+            VG_PROFILE_FUNCTION();
+
             if(enableValidationLayers && !checkValidationLayerSupport()) {
                 std::cerr << "Validation layers are unavailable!\n";
                 
@@ -225,12 +242,14 @@ namespace vg {
                 instInfo.enabledLayerCount = 0;
             }
 
-            if(vkCreateInstance(&instInfo, nullptr, &_instance) != VK_SUCCESS) {
+            if(vkCreateInstance(&instInfo, nullptr, _instance.put()) != VK_SUCCESS) {
                 std::cerr << "Cannot create vulkan instance!\n";
 
                 return 2;
             }
 
+            instanceApiVersion = apiVersion;
+
             uint32_t extensionCount = 0;
             vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
 
@@ -241,39 +260,51 @@ namespace vg {
                 VkDebugUtilsMessengerCreateInfoEXT debug{};
                 populateDebugMessengerCreateInfo(debug);
 
-                if(CreateDebugUtilsMessengerEXT(_instance, &debug, nullptr, &debugMessenger) != VK_SUCCESS) {
+                if(CreateDebugUtilsMessengerEXT(_instance.get(), &debug, nullptr, debugMessenger.put({_instance.get()})) != VK_SUCCESS) {
                     std::cerr << "Cannot create debug messenger!\n";
 
                     return 3;
                 }
             }
+
+            return 0;
         }
     #endif
 
         /**
          * @brief Get the Instance Ptr object
          * 
-         * @return VkInstance* 
+         * @return const VkInstance* 
          */
-        VkInstance* getInstancePtr() { return &_instance; }
+        const VkInstance* getInstancePtr() { return _instance.getPtr(); }
 
         /**
          * @brief Get the Debug Messenger Ptr object
          * 
-         * @return VkDebugUtilsMessengerEXT* 
+         * @return const VkDebugUtilsMessengerEXT* 
          */
-        VkDebugUtilsMessengerEXT* getDebugMessengerPtr() { return &debugMessenger; }
+        const VkDebugUtilsMessengerEXT* getDebugMessengerPtr() { return debugMessenger.getPtr(); }
 
         /**
-         * @brief Destroy the Vg_Instance, please call manually to get desired effect
+         * @brief Get Vulkan version requested when instance was created, device features above it can't be used
          * 
+         * @return uint32_t 
          */
-        ~Vg_Instance() {
-            if(enableValidationLayers)
-                DestroyDebugUtilsMessengerEXT(_instance, debugMessenger, nullptr);
+        uint32_t getApiVersion() { return instanceApiVersion; }
 
-            vkDestroyInstance(_instance, nullptr);
-        }
+        /**
+         * @brief Get the Present Surface
+         * 
+         * @return VkSurfaceKHR 
+         */
+        VkSurfaceKHR getPresentSurface() { return presentSurface.get(); }
+
+        /**
+         * @brief Take ownership of present surface created outside of Vg_Instance (without GLFW), it's destroyed with instance
+         * 
+         * @param surface 
+         */
+        void setPresentSurface(VkSurfaceKHR surface) { presentSurface = SurfaceHandle(surface, {_instance.get()}); }
     };
 
     typedef Vg_Instance Instance;
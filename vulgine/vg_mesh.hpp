@@ -0,0 +1,928 @@
+#pragma once
+#define VG_MESH 1
+
+#include <vulkan/vulkan.hpp>
+
+#ifndef VG_FILE
+#include "vg_file.hpp"
+#endif
+
+#include <vector>
+#include <array>
+#include <string>
+#include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <cmath>
+#include <cstring>
+#include <cstddef>
+
+namespace vg {
+    /**
+     * @brief Convert float to IEEE 754 half float (round to nearest)
+     * 
+     * @param value
+     * @return uint16_t
+     */
+    inline uint16_t floatToHalf(float value) {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+
+        uint32_t sign = (bits >> 16) & 0x8000;
+        int32_t exponent = (int32_t)((bits >> 23) & 0xff) - 127 + 15;
+        uint32_t mantissa = bits & 0x7fffff;
+
+        // NaN and infinity
+        if(((bits >> 23) & 0xff) == 0xff) {
+            return sign | 0x7c00 | (mantissa ? 0x200 : 0);
+        }
+
+        if(exponent >= 31) {
+            return sign | 0x7c00;
+        }
+
+        // Denormals and zero
+        if(exponent <= 0) {
+            if(exponent < -10) {
+                return sign;
+            }
+
+            mantissa |= 0x800000;
+
+            uint32_t shift = 14 - exponent;
+            uint32_t half = mantissa >> shift;
+
+            if((mantissa >> (shift - 1)) & 1) {
+                half++;
+            }
+
+            return sign | half;
+        }
+
+        uint32_t half = sign | (exponent << 10) | (mantissa >> 13);
+
+        // Rounding may carry into exponent, which is still correct
+        if(mantissa & 0x1000) {
+            half++;
+        }
+
+        return half;
+    }
+
+    /**
+     * @brief Source vertex of mesh
+     * 
+     */
+    struct MeshVertex {
+        float position[3];
+        float normal[3];
+        float uv[2];
+    };
+
+    /**
+     * @brief 16 byte vertex, half float position and uv, snorm normal
+     * 
+     */
+    struct QuantizedVertex {
+        uint16_t position[4];
+        int8_t normal[4];
+        uint16_t uv[2];
+
+        static VkVertexInputBindingDescription getBindingDescription() {
+            VkVertexInputBindingDescription binding{};
+            binding.binding = 0;
+            binding.stride = sizeof(QuantizedVertex);
+            binding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+            return binding;
+        }
+
+        static std::array<VkVertexInputAttributeDescription, 3> getAttributeDescriptions() {
+            std::array<VkVertexInputAttributeDescription, 3> attributes{};
+
+            attributes[0].binding = 0;
+            attributes[0].location = 0;
+            attributes[0].format = VK_FORMAT_R16G16B16A16_SFLOAT;
+            attributes[0].offset = offsetof(QuantizedVertex, position);
+
+            attributes[1].binding = 0;
+            attributes[1].location = 1;
+            attributes[1].format = VK_FORMAT_R8G8B8A8_SNORM;
+            attributes[1].offset = offsetof(QuantizedVertex, normal);
+
+            attributes[2].binding = 0;
+            attributes[2].location = 2;
+            attributes[2].format = VK_FORMAT_R16G16_SFLOAT;
+            attributes[2].offset = offsetof(QuantizedVertex, uv);
+
+            return attributes;
+        }
+    };
+
+    /**
+     * @brief Small cluster of triangles with culling bounds. Backfacing when
+     * dot(center - cameraPosition, coneAxis) >= coneCutoff * length(center - cameraPosition) + radius
+     * 
+     */
+    struct Meshlet {
+        uint32_t vertexOffset;
+        uint32_t triangleOffset;
+        uint32_t vertexCount;
+        uint32_t triangleCount;
+        float center[3];
+        float radius;
+        float coneAxis[3];
+        float coneCutoff;
+    };
+
+    /**
+     * @brief Optimized mesh ready for upload, indices are in indices16 when indexType is VK_INDEX_TYPE_UINT16, otherwise in indices
+     * 
+     */
+    struct MeshData {
+        std::vector<QuantizedVertex> vertices;
+        std::vector<uint32_t> indices;
+        std::vector<uint16_t> indices16;
+        VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+        std::vector<Meshlet> meshlets;
+        std::vector<uint32_t> meshletVertices;
+        std::vector<uint8_t> meshletTriangles;
+
+        /**
+         * @brief Get number of indices of used index type
+         * 
+         * @return uint32_t 
+         */
+        uint32_t getIndexCount() const { return indexType == VK_INDEX_TYPE_UINT16 ? indices16.size() : indices.size(); }
+
+        /**
+         * @brief Get indices of used index type for upload
+         * 
+         * @return const void* 
+         */
+        const void* getIndexData() const { return indexType == VK_INDEX_TYPE_UINT16 ? (const void*)indices16.data() : (const void*)indices.data(); }
+
+        /**
+         * @brief Get size of index buffer in bytes
+         * 
+         * @return size_t 
+         */
+        size_t getIndexBytes() const { return (size_t)getIndexCount() * (indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t)); }
+    };
+
+    /**
+     * @brief Source mesh for Vg_MeshBuilder::BuildMany
+     * 
+     */
+    struct MeshSource {
+        std::vector<MeshVertex> vertices;
+        std::vector<uint32_t> indices;
+    };
+
+    struct MeshFileHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        uint32_t meshletCount;
+        uint32_t meshletVertexCount;
+        uint32_t meshletTriangleBytes;
+        uint32_t indexType; // VkIndexType of indices
+        uint64_t verticesOffset;
+        uint64_t indicesOffset;
+        uint64_t meshletsOffset;
+        uint64_t meshletVerticesOffset;
+        uint64_t meshletTrianglesOffset;
+    };
+
+    const char meshFileMagic[4] = {'V', 'G', 'M', 'S'};
+    const uint32_t meshFileVersion = 2;
+
+    class Vg_MeshBuilder {
+    private:
+        static float vertexScore(int cachePosition, uint32_t remainingTriangles, uint32_t cacheSize) {
+            if(remainingTriangles == 0) {
+                return -1.0f;
+            }
+
+            float score = 0.0f;
+
+            if(cachePosition >= 0) {
+                // Last triangle vertices get fixed score, so it doesn't prefer to reuse them over next ones
+                if(cachePosition < 3) {
+                    score = 0.75f;
+                }
+                else {
+                    score = std::pow(1.0f - (float)(cachePosition - 3) / (float)(cacheSize - 3), 1.5f);
+                }
+            }
+
+            return score + 2.0f * std::pow((float)remainingTriangles, -0.5f);
+        }
+
+        static void triangleNormal(const std::vector<MeshVertex>& vertices, const uint32_t* triangle, float* normal) {
+            const float* a = vertices[triangle[0]].position;
+            const float* b = vertices[triangle[1]].position;
+            const float* c = vertices[triangle[2]].position;
+
+            float ab[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+            float ac[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+
+            normal[0] = ab[1] * ac[2] - ab[2] * ac[1];
+            normal[1] = ab[2] * ac[0] - ab[0] * ac[2];
+            normal[2] = ab[0] * ac[1] - ab[1] * ac[0];
+        }
+
+        static void normalize(float* v) {
+            float length = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+
+            if(length > 0.0f) {
+                v[0] /= length;
+                v[1] /= length;
+                v[2] /= length;
+            }
+        }
+
+        void computeMeshletBounds(const std::vector<MeshVertex>& vertices, MeshData& mesh, Meshlet& meshlet) const {
+            const uint32_t* meshletVertices = &mesh.meshletVertices[meshlet.vertexOffset];
+            const uint8_t* meshletTriangles = &mesh.meshletTriangles[meshlet.triangleOffset];
+
+            float minimum[3] = {vertices[meshletVertices[0]].position[0], vertices[meshletVertices[0]].position[1], vertices[meshletVertices[0]].position[2]};
+            float maximum[3] = {minimum[0], minimum[1], minimum[2]};
+
+            for(uint32_t i = 1; i < meshlet.vertexCount; i++) {
+                for(int k = 0; k < 3; k++) {
+                    minimum[k] = std::min(minimum[k], vertices[meshletVertices[i]].position[k]);
+                    maximum[k] = std::max(maximum[k], vertices[meshletVertices[i]].position[k]);
+                }
+            }
+
+            float radiusSquared = 0.0f;
+
+            for(int k = 0; k < 3; k++) {
+                meshlet.center[k] = (minimum[k] + maximum[k]) * 0.5f;
+            }
+
+            for(uint32_t i = 0; i < meshlet.vertexCount; i++) {
+                const float* p = vertices[meshletVertices[i]].position;
+
+                float dx = p[0] - meshlet.center[0];
+                float dy = p[1] - meshlet.center[1];
+                float dz = p[2] - meshlet.center[2];
+
+                radiusSquared = std::max(radiusSquared, dx * dx + dy * dy + dz * dz);
+            }
+
+            meshlet.radius = std::sqrt(radiusSquared);
+
+            std::vector<std::array<float, 3>> normals(meshlet.triangleCount);
+            float axis[3] = {0.0f, 0.0f, 0.0f};
+
+            for(uint32_t t = 0; t < meshlet.triangleCount; t++) {
+                uint32_t triangle[3] = {
+                    meshletVertices[meshletTriangles[t * 3 + 0]],
+                    meshletVertices[meshletTriangles[t * 3 + 1]],
+                    meshletVertices[meshletTriangles[t * 3 + 2]]
+                };
+
+                triangleNormal(vertices, triangle, normals[t].data());
+                normalize(normals[t].data());
+
+                axis[0] += normals[t][0];
+                axis[1] += normals[t][1];
+                axis[2] += normals[t][2];
+            }
+
+            normalize(axis);
+
+            float minDot = 1.0f;
+
+            for(const auto& n : normals) {
+                minDot = std::min(minDot, n[0] * axis[0] + n[1] * axis[1] + n[2] * axis[2]);
+            }
+
+            meshlet.coneAxis[0] = axis[0];
+            meshlet.coneAxis[1] = axis[1];
+            meshlet.coneAxis[2] = axis[2];
+
+            // Normals spread over more than hemisphere, cone can't reject anything
+            meshlet.coneCutoff = minDot <= 0.0f ? 1.0f : std::sqrt(1.0f - minDot * minDot);
+        }
+
+    public:
+        uint32_t cacheSize = 32;
+        uint32_t maxMeshletVertices = 64;
+        uint32_t maxMeshletTriangles = 124;
+
+        /**
+         * @brief Reorder triangles for post-transform vertex cache (Forsyth's algorithm)
+         * 
+         * @param indices triangle list
+         * @param vertexCount number of vertices
+         * @return std::vector<uint32_t> reordered triangle list
+         */
+        std::vector<uint32_t> OptimizeVertexCache(const std::vector<uint32_t>& indices, uint32_t vertexCount) const {
+            uint32_t triangleCount = indices.size() / 3;
+
+            std::vector<uint32_t> remaining(vertexCount, 0);
+            std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+            std::vector<uint32_t> adjacency(triangleCount * 3);
+
+            for(uint32_t i = 0; i < triangleCount * 3; i++) {
+                remaining[indices[i]]++;
+            }
+
+            for(uint32_t v = 0; v < vertexCount; v++) {
+                adjacencyOffsets[v + 1] = adjacencyOffsets[v] + remaining[v];
+            }
+
+            std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+
+            for(uint32_t t = 0; t < triangleCount; t++) {
+                for(int k = 0; k < 3; k++) {
+                    adjacency[fill[indices[t * 3 + k]]++] = t;
+                }
+            }
+
+            std::vector<int> cachePositions(vertexCount, -1);
+            std::vector<float> vertexScores(vertexCount);
+            std::vector<float> triangleScores(triangleCount, 0.0f);
+            std::vector<bool> emitted(triangleCount, false);
+
+            for(uint32_t v = 0; v < vertexCount; v++) {
+                vertexScores[v] = vertexScore(-1, remaining[v], cacheSize);
+            }
+
+            for(uint32_t t = 0; t < triangleCount; t++) {
+                for(int k = 0; k < 3; k++) {
+                    triangleScores[t] += vertexScores[indices[t * 3 + k]];
+                }
+            }
+
+            std::vector<uint32_t> result;
+            result.reserve(triangleCount * 3);
+
+            std::vector<uint32_t> cache;
+            std::vector<uint32_t> newCache;
+            cache.reserve(cacheSize + 3);
+            newCache.reserve(cacheSize + 3);
+
+            int64_t bestTriangle = triangleCount > 0 ? std::max_element(triangleScores.begin(), triangleScores.end()) - triangleScores.begin() : -1;
+            uint32_t cursor = 0;
+
+            while(result.size() < triangleCount * 3) {
+                if(bestTriangle < 0) {
+                    while(emitted[cursor]) {
+                        cursor++;
+                    }
+
+                    bestTriangle = cursor;
+                }
+
+                const uint32_t* triangle = &indices[bestTriangle * 3];
+
+                emitted[bestTriangle] = true;
+
+                for(int k = 0; k < 3; k++) {
+                    uint32_t v = triangle[k];
+
+                    result.push_back(v);
+
+                    // Remove triangle from live adjacency of vertex
+                    uint32_t* begin = &adjacency[adjacencyOffsets[v]];
+                    uint32_t* end = begin + remaining[v];
+                    uint32_t* found = std::find(begin, end, (uint32_t)bestTriangle);
+
+                    if(found != end) {
+                        std::swap(*found, *(end - 1));
+
+                        remaining[v]--;
+                    }
+                }
+
+                newCache.clear();
+
+                for(int k = 0; k < 3; k++) {
+                    if(std::find(newCache.begin(), newCache.end(), triangle[k]) == newCache.end()) {
+                        newCache.push_back(triangle[k]);
+                    }
+                }
+
+                size_t triangleVertices = newCache.size();
+
+                for(uint32_t v : cache) {
+                    if(std::find(newCache.begin(), newCache.begin() + triangleVertices, v) == newCache.begin() + triangleVertices) {
+                        newCache.push_back(v);
+                    }
+                }
+
+                // Evicted vertices lose cache score
+                for(uint32_t i = cacheSize; i < newCache.size(); i++) {
+                    cachePositions[newCache[i]] = -1;
+                }
+
+                if(newCache.size() > cacheSize) {
+                    std::vector<uint32_t> evicted(newCache.begin() + cacheSize, newCache.end());
+
+                    newCache.resize(cacheSize);
+
+                    for(uint32_t v : evicted) {
+                        float score = vertexScore(-1, remaining[v], cacheSize);
+                        float delta = score - vertexScores[v];
+
+                        vertexScores[v] = score;
+
+                        for(uint32_t i = 0; i < remaining[v]; i++) {
+                            triangleScores[adjacency[adjacencyOffsets[v] + i]] += delta;
+                        }
+                    }
+                }
+
+                bestTriangle = -1;
+                float bestScore = -1.0f;
+
+                for(uint32_t i = 0; i < newCache.size(); i++) {
+                    uint32_t v = newCache[i];
+
+                    cachePositions[v] = i;
+
+                    float score = vertexScore(i, remaining[v], cacheSize);
+                    float delta = score - vertexScores[v];
+
+                    vertexScores[v] = score;
+
+                    for(uint32_t j = 0; j < remaining[v]; j++) {
+                        triangleScores[adjacency[adjacencyOffsets[v] + j]] += delta;
+                    }
+                }
+
+                for(uint32_t v : newCache) {
+                    for(uint32_t j = 0; j < remaining[v]; j++) {
+                        uint32_t t = adjacency[adjacencyOffsets[v] + j];
+
+                        if(triangleScores[t] > bestScore) {
+                            bestScore = triangleScores[t];
+                            bestTriangle = t;
+                        }
+                    }
+                }
+
+                std::swap(cache, newCache);
+            }
+
+            return result;
+        }
+
+        /**
+         * @brief Reorder clusters of cache optimized triangles, so outward facing ones are drawn first and occlude the rest
+         * 
+         * @param indices cache optimized triangle list
+         * @param vertices mesh vertices
+         * @return std::vector<uint32_t> reordered triangle list
+         */
+        std::vector<uint32_t> OptimizeOverdraw(const std::vector<uint32_t>& indices, const std::vector<MeshVertex>& vertices) const {
+            uint32_t triangleCount = indices.size() / 3;
+
+            if(triangleCount == 0) {
+                return indices;
+            }
+
+            // Cluster ends where vertex cache restarts (triangle with all vertices missing), keeps most of cache efficiency
+            std::vector<uint32_t> clusterStarts = {0};
+            std::vector<uint32_t> cacheTimestamps(vertices.size(), 0);
+            uint32_t time = cacheSize + 1;
+
+            for(uint32_t t = 0; t < triangleCount; t++) {
+                int misses = 0;
+
+                for(int k = 0; k < 3; k++) {
+                    uint32_t v = indices[t * 3 + k];
+
+                    if(time - cacheTimestamps[v] > cacheSize) {
+                        cacheTimestamps[v] = time++;
+                        misses++;
+                    }
+                }
+
+                if(misses == 3 && t - clusterStarts.back() >= 16) {
+                    clusterStarts.push_back(t);
+                }
+            }
+
+            clusterStarts.push_back(triangleCount);
+
+            float meshCentroid[3] = {0.0f, 0.0f, 0.0f};
+
+            for(const auto& vertex : vertices) {
+                meshCentroid[0] += vertex.position[0] / vertices.size();
+                meshCentroid[1] += vertex.position[1] / vertices.size();
+                meshCentroid[2] += vertex.position[2] / vertices.size();
+            }
+
+            uint32_t clusterCount = clusterStarts.size() - 1;
+            std::vector<float> sortKeys(clusterCount);
+
+            for(uint32_t c = 0; c < clusterCount; c++) {
+                float centroid[3] = {0.0f, 0.0f, 0.0f};
+                float normal[3] = {0.0f, 0.0f, 0.0f};
+                float area = 0.0f;
+
+                for(uint32_t t = clusterStarts[c]; t < clusterStarts[c + 1]; t++) {
+                    float n[3];
+                    triangleNormal(vertices, &indices[t * 3], n);
+
+                    float triangleArea = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+                    for(int k = 0; k < 3; k++) {
+                        float triangleCentroid = (vertices[indices[t * 3]].position[k] + vertices[indices[t * 3 + 1]].position[k] + vertices[indices[t * 3 + 2]].position[k]) / 3.0f;
+
+                        centroid[k] += triangleCentroid * triangleArea;
+                        normal[k] += n[k];
+                    }
+
+                    area += triangleArea;
+                }
+
+                if(area > 0.0f) {
+                    centroid[0] /= area;
+                    centroid[1] /= area;
+                    centroid[2] /= area;
+                }
+
+                normalize(normal);
+
+                sortKeys[c] = (centroid[0] - meshCentroid[0]) * normal[0] + (centroid[1] - meshCentroid[1]) * normal[1] + (centroid[2] - meshCentroid[2]) * normal[2];
+            }
+
+            std::vector<uint32_t> clusterOrder(clusterCount);
+
+            for(uint32_t c = 0; c < clusterCount; c++) {
+                clusterOrder[c] = c;
+            }
+
+            std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+            std::vector<uint32_t> result;
+            result.reserve(indices.size());
+
+            for(uint32_t c : clusterOrder) {
+                result.insert(result.end(), indices.begin() + clusterStarts[c] * 3, indices.begin() + clusterStarts[c + 1] * 3);
+            }
+
+            return result;
+        }
+
+        /**
+         * @brief Reorder vertices in order of first use in index buffer, unused vertices are removed
+         * 
+         * @param indices triangle list, remapped in place
+         * @param vertices mesh vertices, reordered in place
+         */
+        void OptimizeVertexFetch(std::vector<uint32_t>& indices, std::vector<MeshVertex>& vertices) const {
+            std::vector<uint32_t> remap(vertices.size(), UINT32_MAX);
+            std::vector<MeshVertex> reordered;
+            reordered.reserve(vertices.size());
+
+            for(auto& index : indices) {
+                if(remap[index] == UINT32_MAX) {
+                    remap[index] = reordered.size();
+                    reordered.push_back(vertices[index]);
+                }
+
+                index = remap[index];
+            }
+
+            vertices = std::move(reordered);
+        }
+
+        /**
+         * @brief Quantize vertex to half float position and uv and snorm normal
+         * 
+         * @param vertex
+         * @return QuantizedVertex
+         */
+        static QuantizedVertex Quantize(const MeshVertex& vertex) {
+            QuantizedVertex quantized{};
+
+            for(int k = 0; k < 3; k++) {
+                quantized.position[k] = floatToHalf(vertex.position[k]);
+                quantized.normal[k] = (int8_t)std::lround(std::clamp(vertex.normal[k], -1.0f, 1.0f) * 127.0f);
+            }
+
+            quantized.position[3] = floatToHalf(1.0f);
+            quantized.uv[0] = floatToHalf(vertex.uv[0]);
+            quantized.uv[1] = floatToHalf(vertex.uv[1]);
+
+            return quantized;
+        }
+
+        /**
+         * @brief Split triangle list into meshlets with bounding sphere and normal cone
+         * 
+         * @param indices triangle list
+         * @param vertices mesh vertices
+         * @param mesh meshlets, meshletVertices and meshletTriangles are written to it
+         */
+        void BuildMeshlets(const std::vector<uint32_t>& indices, const std::vector<MeshVertex>& vertices, MeshData& mesh) const {
+            std::vector<uint32_t> localIndex(vertices.size(), UINT32_MAX);
+
+            Meshlet meshlet{};
+
+            auto flush = [&]() {
+                if(meshlet.triangleCount == 0) {
+                    return;
+                }
+
+                for(uint32_t i = 0; i < meshlet.vertexCount; i++) {
+                    localIndex[mesh.meshletVertices[meshlet.vertexOffset + i]] = UINT32_MAX;
+                }
+
+                computeMeshletBounds(vertices, mesh, meshlet);
+
+                mesh.meshlets.push_back(meshlet);
+
+                // Triangles of every meshlet start at 4 byte boundary
+                while(mesh.meshletTriangles.size() % 4 != 0) {
+                    mesh.meshletTriangles.push_back(0);
+                }
+
+                meshlet = {};
+                meshlet.vertexOffset = mesh.meshletVertices.size();
+                meshlet.triangleOffset = mesh.meshletTriangles.size();
+            };
+
+            for(uint32_t t = 0; t < indices.size() / 3; t++) {
+                const uint32_t* triangle = &indices[t * 3];
+
+                uint32_t newVertices = 0;
+
+                for(int k = 0; k < 3; k++) {
+                    if(localIndex[triangle[k]] == UINT32_MAX && (k == 0 || triangle[k] != triangle[0]) && (k < 2 || triangle[k] != triangle[1])) {
+                        newVertices++;
+                    }
+                }
+
+                if(meshlet.vertexCount + newVertices > maxMeshletVertices || meshlet.triangleCount >= maxMeshletTriangles) {
+                    flush();
+                }
+
+                for(int k = 0; k < 3; k++) {
+                    uint32_t v = triangle[k];
+
+                    if(localIndex[v] == UINT32_MAX) {
+                        localIndex[v] = meshlet.vertexCount++;
+
+                        mesh.meshletVertices.push_back(v);
+                    }
+
+                    mesh.meshletTriangles.push_back((uint8_t)localIndex[v]);
+                }
+
+                meshlet.triangleCount++;
+            }
+
+            flush();
+        }
+
+        /**
+         * @brief Run all optimizations, quantization and meshlet building on mesh.
+         * Indices are 16-bit when every vertex can be addressed by them
+         * 
+         * @param sourceVertices mesh vertices
+         * @param sourceIndices triangle list
+         * @return MeshData
+         */
+        MeshData Build(const std::vector<MeshVertex>& sourceVertices, const std::vector<uint32_t>& sourceIndices) const {
+            std::vector<MeshVertex> vertices = sourceVertices;
+
+            std::vector<uint32_t> indices = OptimizeVertexCache(sourceIndices, vertices.size());
+            indices = OptimizeOverdraw(indices, vertices);
+
+            OptimizeVertexFetch(indices, vertices);
+
+            MeshData mesh;
+            mesh.vertices.resize(vertices.size());
+
+            for(uint32_t i = 0; i < vertices.size(); i++) {
+                mesh.vertices[i] = Quantize(vertices[i]);
+            }
+
+            BuildMeshlets(indices, vertices, mesh);
+
+            if(vertices.size() <= 65536) {
+                mesh.indices16.assign(indices.begin(), indices.end());
+                mesh.indexType = VK_INDEX_TYPE_UINT16;
+            }
+            else {
+                mesh.indices = std::move(indices);
+                mesh.indexType = VK_INDEX_TYPE_UINT32;
+            }
+
+            return mesh;
+        }
+
+        /**
+         * @brief Build many meshes on worker threads
+         * 
+         * @param sources source meshes
+         * @param threadCount number of threads (0 uses all cores)
+         * @return std::vector<MeshData> built meshes in order of sources
+         */
+        std::vector<MeshData> BuildMany(const std::vector<MeshSource>& sources, uint32_t threadCount = 0) const {
+            std::vector<MeshData> meshes(sources.size());
+            std::atomic<size_t> next{0};
+
+            if(threadCount == 0) {
+                threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+            }
+
+            threadCount = std::min<size_t>(threadCount, sources.size());
+
+            auto worker = [&]() {
+                for(size_t i = next++; i < sources.size(); i = next++) {
+                    meshes[i] = Build(sources[i].vertices, sources[i].indices);
+                }
+            };
+
+            std::vector<std::thread> threads;
+
+            for(uint32_t i = 1; i < threadCount; i++) {
+                threads.emplace_back(worker);
+            }
+
+            worker();
+
+            for(auto& thread : threads) {
+                thread.join();
+            }
+
+            return meshes;
+        }
+
+        /**
+         * @brief Write mesh to binary file that can be memory mapped with Vg_MeshFile
+         * 
+         * @param mesh built mesh
+         * @param path output path
+         * @return int 0 on success, 1 when file cannot be written
+         */
+        static int Write(const MeshData& mesh, const std::string& path) {
+            auto align = [](uint64_t offset) { return (offset + 15) & ~(uint64_t)15; };
+
+            MeshFileHeader header{};
+            memcpy(header.magic, meshFileMagic, sizeof(header.magic));
+            header.version = meshFileVersion;
+            header.vertexCount = mesh.vertices.size();
+            header.indexCount = mesh.getIndexCount();
+            header.indexType = mesh.indexType;
+            header.meshletCount = mesh.meshlets.size();
+            header.meshletVertexCount = mesh.meshletVertices.size();
+            header.meshletTriangleBytes = mesh.meshletTriangles.size();
+
+            header.verticesOffset = align(sizeof(MeshFileHeader));
+            header.indicesOffset = align(header.verticesOffset + mesh.vertices.size() * sizeof(QuantizedVertex));
+            header.meshletsOffset = align(header.indicesOffset + mesh.getIndexBytes());
+            header.meshletVerticesOffset = align(header.meshletsOffset + mesh.meshlets.size() * sizeof(Meshlet));
+            header.meshletTrianglesOffset = align(header.meshletVerticesOffset + mesh.meshletVertices.size() * sizeof(uint32_t));
+
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+
+            if(!file.is_open()) {
+                std::cerr << "Cannot write mesh file " << path << "!\n";
+
+                return 1;
+            }
+
+            auto writeAt = [&](uint64_t offset, const void* data, size_t size) {
+                static const char padding[16] = {};
+
+                file.write(padding, offset - (uint64_t)file.tellp());
+                file.write((const char*)data, size);
+            };
+
+            file.write((const char*)&header, sizeof(header));
+
+            writeAt(header.verticesOffset, mesh.vertices.data(), mesh.vertices.size() * sizeof(QuantizedVertex));
+            writeAt(header.indicesOffset, mesh.getIndexData(), mesh.getIndexBytes());
+            writeAt(header.meshletsOffset, mesh.meshlets.data(), mesh.meshlets.size() * sizeof(Meshlet));
+            writeAt(header.meshletVerticesOffset, mesh.meshletVertices.data(), mesh.meshletVertices.size() * sizeof(uint32_t));
+            writeAt(header.meshletTrianglesOffset, mesh.meshletTriangles.data(), mesh.meshletTriangles.size());
+
+            if(!file.good()) {
+                std::cerr << "Cannot write mesh file " << path << "!\n";
+
+                return 1;
+            }
+
+            return 0;
+        }
+    };
+
+    /**
+     * @brief Memory mapped mesh written by Vg_MeshBuilder::Write, arrays point directly into mapping
+     * 
+     */
+    class Vg_MeshFile {
+    private:
+        MappedFile file;
+        const MeshFileHeader* header = nullptr;
+
+        template<typename T>
+        const T* at(uint64_t offset) const { return reinterpret_cast<const T*>(file.getData() + offset); }
+
+        // Written this way, so offset + bytes can't overflow
+        bool isSectionValid(uint64_t offset, uint64_t bytes, uint64_t alignment) const {
+            return offset % alignment == 0 && offset <= file.getSize() && bytes <= file.getSize() - offset;
+        }
+
+        bool isValid(const MeshFileHeader* h) const {
+            if(file.getSize() < sizeof(MeshFileHeader) || memcmp(h->magic, meshFileMagic, sizeof(meshFileMagic)) != 0 || h->version != meshFileVersion) {
+                return false;
+            }
+
+            uint64_t indexSize;
+
+            if(h->indexType == VK_INDEX_TYPE_UINT16 && h->vertexCount <= 65536) {
+                indexSize = sizeof(uint16_t);
+            }
+            else if(h->indexType == VK_INDEX_TYPE_UINT32) {
+                indexSize = sizeof(uint32_t);
+            }
+            else {
+                return false;
+            }
+
+            // Counts are 32-bit, so their sizes in bytes fit to 64-bit
+            if(h->indexCount % 3 != 0 ||
+                !isSectionValid(h->verticesOffset, (uint64_t)h->vertexCount * sizeof(QuantizedVertex), alignof(QuantizedVertex)) ||
+                !isSectionValid(h->indicesOffset, (uint64_t)h->indexCount * indexSize, indexSize) ||
+                !isSectionValid(h->meshletsOffset, (uint64_t)h->meshletCount * sizeof(Meshlet), alignof(Meshlet)) ||
+                !isSectionValid(h->meshletVerticesOffset, (uint64_t)h->meshletVertexCount * sizeof(uint32_t), alignof(uint32_t)) ||
+                !isSectionValid(h->meshletTrianglesOffset, h->meshletTriangleBytes, 1)) {
+                return false;
+            }
+
+            const Meshlet* meshlets = at<Meshlet>(h->meshletsOffset);
+
+            for(uint32_t i = 0; i < h->meshletCount; i++) {
+                if((uint64_t)meshlets[i].vertexOffset + meshlets[i].vertexCount > h->meshletVertexCount ||
+                    (uint64_t)meshlets[i].triangleOffset + (uint64_t)meshlets[i].triangleCount * 3 > h->meshletTriangleBytes) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+    public:
+        /**
+         * @brief Map and validate mesh file, header, section ranges and meshlet ranges are checked, index values are not
+         * 
+         * @param path path to mesh file
+         * @return int 0 on success, 1 when file cannot be mapped, 2 when it is not valid mesh file
+         */
+        int Open(const std::string& path) {
+            header = nullptr;
+
+            if(file.Open(path) != 0) {
+                return 1;
+            }
+
+            const MeshFileHeader* h = at<MeshFileHeader>(0);
+
+            if(!isValid(h)) {
+                std::cerr << "Invalid mesh file " << path << "!\n";
+
+                file.Close();
+
+                return 2;
+            }
+
+            header = h;
+
+            return 0;
+        }
+
+        const MeshFileHeader* getHeader() const { return header; }
+
+        const QuantizedVertex* getVertices() const { return at<QuantizedVertex>(header->verticesOffset); }
+        uint32_t getVertexCount() const { return header->vertexCount; }
+
+        const void* getIndexData() const { return at<uint8_t>(header->indicesOffset); }
+        uint32_t getIndexCount() const { return header->indexCount; }
+        VkIndexType getIndexType() const { return (VkIndexType)header->indexType; }
+
+        const Meshlet* getMeshlets() const { return at<Meshlet>(header->meshletsOffset); }
+        uint32_t getMeshletCount() const { return header->meshletCount; }
+
+        const uint32_t* getMeshletVertices() const { return at<uint32_t>(header->meshletVerticesOffset); }
+        uint32_t getMeshletVertexCount() const { return header->meshletVertexCount; }
+
+        const uint8_t* getMeshletTriangles() const { return at<uint8_t>(header->meshletTrianglesOffset); }
+        uint32_t getMeshletTriangleBytes() const { return header->meshletTriangleBytes; }
+    };
+
+    typedef Vg_MeshBuilder MeshBuilder;
+    typedef Vg_MeshFile MeshFile;
+}
@@ -0,0 +1,275 @@
+#pragma once
+#define VG_PROFILER 1
+
+#include <cstdint>
+#include <cstdlib>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <string>
+#include <fstream>
+
+/*
+ * Define VG_PROFILE before including vulgine to record CPU zones,
+ * without it all VG_PROFILE_* macros compile to nothing.
+ * Trace is written at exit (also on exit-on-error paths) to $VG_TRACE_FILE or vulgine_trace.json,
+ * open it in chrome://tracing or ui.perfetto.dev.
+ */
+#ifdef VG_PROFILE
+#define VG_PROFILE_CONCAT_(a, b) a##b
+#define VG_PROFILE_CONCAT(a, b) VG_PROFILE_CONCAT_(a, b)
+#define VG_PROFILE_ZONE(name) vg::ProfileZone VG_PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define VG_PROFILE_FUNCTION() VG_PROFILE_ZONE(__func__)
+#define VG_PROFILE_MARK(name) vg::Vg_Profiler::get().Record(name, vg::ProfileEventType::Instant)
+#define VG_PROFILE_EXIT(code) vg::Vg_Profiler::get().Record("exit", vg::ProfileEventType::Instant, code)
+#define VG_PROFILE_THREAD(name) vg::Vg_Profiler::get().SetThreadName(name)
+#else
+#define VG_PROFILE_ZONE(name)
+#define VG_PROFILE_FUNCTION()
+#define VG_PROFILE_MARK(name)
+#define VG_PROFILE_EXIT(code)
+#define VG_PROFILE_THREAD(name)
+#endif
+
+namespace vg {
+    enum class ProfileEventType : uint8_t {
+        Begin,
+        End,
+        Instant
+    };
+
+    struct ProfileEvent {
+        const char* name;
+        uint64_t timestamp;
+        int64_t value;
+        ProfileEventType type;
+    };
+
+    const uint32_t profileBlockSize = 4096;
+
+    struct ProfileBlock {
+        ProfileEvent events[profileBlockSize];
+        std::atomic<uint32_t> count{0};
+        std::atomic<ProfileBlock*> next{nullptr};
+    };
+
+    /**
+     * @brief Events of one thread, appended only by owning thread and published with release store,
+     * so export can read them while thread keeps recording
+     * 
+     */
+    struct ProfileThreadBuffer {
+        ProfileBlock* first = nullptr;
+        ProfileBlock* current = nullptr;
+        uint32_t threadId = 0;
+        std::string name;
+
+        void Push(const char* eventName, uint64_t timestamp, int64_t value, ProfileEventType type) {
+            uint32_t index = current->count.load(std::memory_order_relaxed);
+
+            if(index == profileBlockSize) {
+                ProfileBlock* block = new ProfileBlock();
+
+                current->next.store(block, std::memory_order_release);
+                current = block;
+                index = 0;
+            }
+
+            current->events[index] = {eventName, timestamp, value, type};
+            current->count.store(index + 1, std::memory_order_release);
+        }
+    };
+
+    class Vg_Profiler {
+    private:
+        // Guards only thread registration and export, recording doesn't lock
+        std::mutex mutex;
+        std::vector<std::unique_ptr<ProfileThreadBuffer>> threads;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::string outputPath;
+
+        Vg_Profiler() {
+            const char* path = std::getenv("VG_TRACE_FILE");
+
+            outputPath = path != nullptr ? path : "vulgine_trace.json";
+        }
+
+        ProfileThreadBuffer* registerThread() {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            std::unique_ptr<ProfileThreadBuffer> buffer(new ProfileThreadBuffer());
+            buffer->first = buffer->current = new ProfileBlock();
+            buffer->threadId = threads.size() + 1;
+
+            threads.push_back(std::move(buffer));
+
+            return threads.back().get();
+        }
+
+        static ProfileThreadBuffer* threadBuffer() {
+            thread_local ProfileThreadBuffer* buffer = get().registerThread();
+
+            return buffer;
+        }
+
+        static void writeEscaped(std::ofstream& file, const char* text) {
+            for(; *text != '\0'; text++) {
+                if(*text == '"' || *text == '\\') {
+                    file << '\\';
+                }
+
+                file << *text;
+            }
+        }
+
+    public:
+        Vg_Profiler(const Vg_Profiler&) = delete;
+        Vg_Profiler& operator=(const Vg_Profiler&) = delete;
+
+        /**
+         * @brief Get the Profiler, first call registers trace write at exit
+         * 
+         * @return Vg_Profiler&
+         */
+        static Vg_Profiler& get() {
+            static Vg_Profiler profiler;
+            static bool registered = (std::atexit([]() { get().WriteChromeTrace(get().outputPath); }) == 0);
+
+            (void)registered;
+
+            return profiler;
+        }
+
+        /**
+         * @brief Append event to calling thread buffer
+         * 
+         * @param name string with static storage (literal, __func__)
+         * @param type
+         * @param value shown as "value" arg of instant events (eg. exit code)
+         */
+        void Record(const char* name, ProfileEventType type, int64_t value = 0) {
+            uint64_t timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+            threadBuffer()->Push(name, timestamp, value, type);
+        }
+
+        /**
+         * @brief Name calling thread in trace
+         * 
+         * @param name
+         */
+        void SetThreadName(const char* name) {
+            ProfileThreadBuffer* buffer = threadBuffer();
+
+            std::lock_guard<std::mutex> lock(mutex);
+
+            buffer->name = name;
+        }
+
+        /**
+         * @brief Write events recorded so far as Chrome trace JSON
+         * 
+         * @param path
+         * @return bool false when file can't be opened
+         */
+        bool WriteChromeTrace(const std::string& path) {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            std::ofstream file(path);
+
+            if(!file.is_open()) {
+                return false;
+            }
+
+            file << "{\"traceEvents\":[\n";
+
+            bool firstEvent = true;
+
+            for(const std::unique_ptr<ProfileThreadBuffer>& thread : threads) {
+                if(!thread->name.empty()) {
+                    file << (firstEvent ? "" : ",\n") << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << thread->threadId << ",\"args\":{\"name\":\"";
+                    writeEscaped(file, thread->name.c_str());
+                    file << "\"}}";
+
+                    firstEvent = false;
+                }
+
+                for(ProfileBlock* block = thread->first; block != nullptr; block = block->next.load(std::memory_order_acquire)) {
+                    uint32_t count = block->count.load(std::memory_order_acquire);
+
+                    for(uint32_t i = 0; i < count; i++) {
+                        const ProfileEvent& event = block->events[i];
+
+                        const char* phase = event.type == ProfileEventType::Begin ? "B" : (event.type == ProfileEventType::End ? "E" : "i");
+
+                        file << (firstEvent ? "" : ",\n") << "{\"ph\":\"" << phase << "\",\"name\":\"";
+                        writeEscaped(file, event.name);
+                        file << "\",\"pid\":1,\"tid\":" << thread->threadId << ",\"ts\":" << event.timestamp / 1000 << "." << std::to_string(1000 + event.timestamp % 1000).substr(1);
+
+                        if(event.type == ProfileEventType::Instant) {
+                            file << ",\"s\":\"t\",\"args\":{\"value\":" << event.value << "}";
+                        }
+
+                        file << "}";
+
+                        firstEvent = false;
+                    }
+                }
+            }
+
+            file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+            return true;
+        }
+
+        /**
+         * @brief Set path of trace written at exit
+         * 
+         * @param path
+         */
+        void setOutputPath(const std::string& path) {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            outputPath = path;
+        }
+
+        ~Vg_Profiler() {
+            for(const std::unique_ptr<ProfileThreadBuffer>& thread : threads) {
+                ProfileBlock* block = thread->first;
+
+                while(block != nullptr) {
+                    ProfileBlock* next = block->next.load(std::memory_order_relaxed);
+
+                    delete block;
+                    block = next;
+                }
+            }
+        }
+    };
+
+    typedef Vg_Profiler Profiler;
+
+    /**
+     * @brief Records Begin on construction and End on scope exit, use through VG_PROFILE_ZONE
+     * 
+     */
+    class ProfileZone {
+    private:
+        const char* name;
+
+    public:
+        ProfileZone(const char* _name) : name(_name) {
+            Vg_Profiler::get().Record(name, ProfileEventType::Begin);
+        }
+
+        ProfileZone(const ProfileZone&) = delete;
+        ProfileZone& operator=(const ProfileZone&) = delete;
+
+        ~ProfileZone() {
+            Vg_Profiler::get().Record(name, ProfileEventType::End);
+        }
+    };
+}
@@ -0,0 +1,494 @@
+#pragma once
+#define VG_SUBMIT 1
+
+#ifndef VG_DEVICES
+#include "vg_devices.hpp"
+#endif
+
+#ifndef VG_SWAPCHAIN
+#include "vg_swapchain.hpp"
+#endif
+
+#include <atomic>
+#include <vector>
+#include <map>
+
+namespace vg {
+    /**
+     * @brief Lock-free multi-producer single-consumer queue (Vyukov)
+     * 
+     * Push can be called from any thread, Pop only from one consumer thread.
+     * Element pushed while Pop runs can be seen on next Pop.
+     */
+    template<typename T>
+    class Vg_MpscQueue {
+    private:
+        struct Node {
+            std::atomic<Node*> next{nullptr};
+            T value{};
+        };
+
+        std::atomic<Node*> head;
+        Node* tail;
+
+    public:
+        Vg_MpscQueue() {
+            Node* stub = new Node();
+
+            head.store(stub, std::memory_order_relaxed);
+            tail = stub;
+        }
+
+        Vg_MpscQueue(const Vg_MpscQueue&) = delete;
+        Vg_MpscQueue& operator=(const Vg_MpscQueue&) = delete;
+
+        /**
+         * @brief Add element to queue, thread-safe
+         * 
+         * @param value
+         */
+        void Push(T value) {
+            Node* node = new Node();
+            node->value = std::move(value);
+
+            Node* previous = head.exchange(node, std::memory_order_acq_rel);
+            previous->next.store(node, std::memory_order_release);
+        }
+
+        /**
+         * @brief Take oldest element from queue, consumer thread only
+         * 
+         * @param value taken element
+         * @return bool false when queue is empty
+         */
+        bool Pop(T& value) {
+            Node* next = tail->next.load(std::memory_order_acquire);
+
+            if(next == nullptr) {
+                return false;
+            }
+
+            value = std::move(next->value);
+
+            delete tail;
+            tail = next;
+
+            return true;
+        }
+
+        ~Vg_MpscQueue() {
+            T value;
+
+            while(Pop(value));
+
+            delete tail;
+        }
+    };
+
+    struct SubmitRequest {
+        VkQueue queue = VK_NULL_HANDLE;
+        std::vector<VkCommandBuffer> commandBuffers;
+        std::vector<VkSemaphore> waitSemaphores;
+        std::vector<VkPipelineStageFlags> waitStages;
+        std::vector<VkSemaphore> signalSemaphores;
+    };
+
+    struct PresentRequest {
+        VkQueue queue = VK_NULL_HANDLE;
+        Swapchain* pSwapchain = nullptr;
+        uint32_t imageIndex = 0;
+        VkSemaphore waitSemaphore = VK_NULL_HANDLE;
+    };
+
+    /**
+     * @brief Thread-safe submission layer over Device queues
+     * 
+     * Any thread can Submit/Present, one thread calls Flush once per frame.
+     * Flush orders requests by their semaphores, makes one submit call per run of requests
+     * on same queue and one vkQueuePresentKHR per present queue (more when swapchain is presented
+     * more times in one Flush, its presents keep their order). Presents are tagged with
+     * present ids of their Swapchain, so its PaceFrame works same as with Swapchain::Present.
+     * Queues passed to batcher shouldn't be used directly by other code (Vulkan requires external sync).
+     */
+    class Vg_SubmitBatcher {
+    private:
+        Vg_MpscQueue<SubmitRequest> submits;
+        Vg_MpscQueue<PresentRequest> presents;
+
+        Device* pDevice = nullptr;
+
+        PFN_vkQueueSubmit2KHR queueSubmit2 = nullptr;
+
+        std::vector<SubmitRequest> pending;
+        std::vector<uint32_t> order;
+
+        // Signaled by last run of every other queue and waited before fence, fence of frame guards their reuse
+        std::map<std::pair<VkFence, VkQueue>, SemaphoreHandle> joinSemaphores;
+
+        VkSemaphore getJoinSemaphore(VkFence fence, VkQueue queue) {
+            SemaphoreHandle& semaphore = joinSemaphores[{fence, queue}];
+
+            if(!semaphore) {
+                VkDevice device = *pDevice->getLogicalDevicePtr();
+                VkSemaphoreCreateInfo semaphoreInfo{VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+
+                if(vkCreateSemaphore(device, &semaphoreInfo, nullptr, semaphore.put({device})) != VK_SUCCESS) {
+                    std::cerr << "Cannot create submit semaphore!\n";
+
+                    VG_PROFILE_EXIT(30);
+                    exit(30);
+                }
+            }
+
+            return semaphore.get();
+        }
+
+        VkResult submitRun(uint32_t first, uint32_t last, VkSemaphore joinSemaphore, VkFence fence) {
+            VG_PROFILE_FUNCTION();
+
+            VkQueue queue = pending[order[first]].queue;
+            uint32_t runSize = last - first;
+
+            if(queueSubmit2 != nullptr) {
+                std::vector<VkSubmitInfo2KHR> submitInfos(runSize, {VK_STRUCTURE_TYPE_SUBMIT_INFO_2_KHR});
+                std::vector<std::vector<VkCommandBufferSubmitInfoKHR>> commandInfos(runSize);
+                std::vector<std::vector<VkSemaphoreSubmitInfoKHR>> waitInfos(runSize);
+                std::vector<std::vector<VkSemaphoreSubmitInfoKHR>> signalInfos(runSize);
+
+                for(uint32_t i = 0; i < runSize; i++) {
+                    const SubmitRequest& request = pending[order[first + i]];
+
+                    for(VkCommandBuffer commandBuffer : request.commandBuffers) {
+                        VkCommandBufferSubmitInfoKHR commandInfo{VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO_KHR};
+                        commandInfo.commandBuffer = commandBuffer;
+
+                        commandInfos[i].push_back(commandInfo);
+                    }
+
+                    for(size_t j = 0; j < request.waitSemaphores.size(); j++) {
+                        VkSemaphoreSubmitInfoKHR waitInfo{VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO_KHR};
+                        waitInfo.semaphore = request.waitSemaphores[j];
+                        waitInfo.stageMask = j < request.waitStages.size() ? request.waitStages[j] : (VkPipelineStageFlags)VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+                        waitInfos[i].push_back(waitInfo);
+                    }
+
+                    for(VkSemaphore semaphore : request.signalSemaphores) {
+                        VkSemaphoreSubmitInfoKHR signalInfo{VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO_KHR};
+                        signalInfo.semaphore = semaphore;
+                        signalInfo.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT_KHR;
+
+                        signalInfos[i].push_back(signalInfo);
+                    }
+
+                    if(joinSemaphore != VK_NULL_HANDLE && i == runSize - 1) {
+                        VkSemaphoreSubmitInfoKHR signalInfo{VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO_KHR};
+                        signalInfo.semaphore = joinSemaphore;
+                        signalInfo.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT_KHR;
+
+                        signalInfos[i].push_back(signalInfo);
+                    }
+
+                    submitInfos[i].commandBufferInfoCount = commandInfos[i].size();
+                    submitInfos[i].pCommandBufferInfos = commandInfos[i].data();
+                    submitInfos[i].waitSemaphoreInfoCount = waitInfos[i].size();
+                    submitInfos[i].pWaitSemaphoreInfos = waitInfos[i].data();
+                    submitInfos[i].signalSemaphoreInfoCount = signalInfos[i].size();
+                    submitInfos[i].pSignalSemaphoreInfos = signalInfos[i].data();
+                }
+
+                return queueSubmit2(queue, submitInfos.size(), submitInfos.data(), fence);
+            }
+
+            std::vector<VkSubmitInfo> submitInfos(runSize, {VK_STRUCTURE_TYPE_SUBMIT_INFO});
+            std::vector<std::vector<VkPipelineStageFlags>> waitStages(runSize);
+            std::vector<VkSemaphore> lastSignals = pending[order[last - 1]].signalSemaphores;
+
+            if(joinSemaphore != VK_NULL_HANDLE) {
+                lastSignals.push_back(joinSemaphore);
+            }
+
+            for(uint32_t i = 0; i < runSize; i++) {
+                const SubmitRequest& request = pending[order[first + i]];
+
+                waitStages[i] = request.waitStages;
+                waitStages[i].resize(request.waitSemaphores.size(), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+
+                submitInfos[i].commandBufferCount = request.commandBuffers.size();
+                submitInfos[i].pCommandBuffers = request.commandBuffers.data();
+                submitInfos[i].waitSemaphoreCount = request.waitSemaphores.size();
+                submitInfos[i].pWaitSemaphores = request.waitSemaphores.data();
+                submitInfos[i].pWaitDstStageMask = waitStages[i].data();
+                submitInfos[i].signalSemaphoreCount = request.signalSemaphores.size();
+                submitInfos[i].pSignalSemaphores = request.signalSemaphores.data();
+            }
+
+            submitInfos.back().signalSemaphoreCount = lastSignals.size();
+            submitInfos.back().pSignalSemaphores = lastSignals.data();
+
+            return vkQueueSubmit(queue, submitInfos.size(), submitInfos.data(), fence);
+        }
+
+    public:
+        /**
+         * @brief Order requests so every semaphore signal comes before its wait (Kahn),
+         * prefers ready request on same queue as previous one, so arrival order is kept only within a queue
+         * 
+         * @param requests
+         * @param order indices of requests in submit order
+         */
+        static void SortRequests(const std::vector<SubmitRequest>& requests, std::vector<uint32_t>& order) {
+            size_t count = requests.size();
+
+            std::map<VkSemaphore, uint32_t> signalers;
+
+            for(uint32_t i = 0; i < count; i++) {
+                for(VkSemaphore semaphore : requests[i].signalSemaphores) {
+                    signalers[semaphore] = i;
+                }
+            }
+
+            std::vector<uint32_t> dependencies(count, 0);
+            std::vector<std::vector<uint32_t>> dependents(count);
+
+            for(uint32_t i = 0; i < count; i++) {
+                for(VkSemaphore semaphore : requests[i].waitSemaphores) {
+                    auto signaler = signalers.find(semaphore);
+
+                    if(signaler != signalers.end() && signaler->second != i) {
+                        dependencies[i]++;
+                        dependents[signaler->second].push_back(i);
+                    }
+                }
+            }
+
+            order.clear();
+
+            std::vector<bool> emitted(count, false);
+            VkQueue lastQueue = VK_NULL_HANDLE;
+
+            while(order.size() < count) {
+                int64_t next = -1;
+
+                for(uint32_t i = 0; i < count; i++) {
+                    if(emitted[i] || dependencies[i] != 0) {
+                        continue;
+                    }
+
+                    if(next == -1) {
+                        next = i;
+                    }
+
+                    if(requests[i].queue == lastQueue) {
+                        next = i;
+                        break;
+                    }
+                }
+
+                if(next == -1) {
+                    std::cerr << "Submit requests have cyclic semaphore dependencies!\n";
+
+                    for(uint32_t i = 0; i < count; i++) {
+                        if(!emitted[i]) {
+                            order.push_back(i);
+                        }
+                    }
+
+                    break;
+                }
+
+                emitted[next] = true;
+                order.push_back(next);
+                lastQueue = requests[next].queue;
+
+                for(uint32_t dependent : dependents[next]) {
+                    dependencies[dependent]--;
+                }
+            }
+        }
+
+        /**
+         * @brief Create Submit Batcher, uses vkQueueSubmit2KHR when Device has synchronization2 enabled
+         * 
+         * @param _pDevice pointer to created Device
+         */
+        void CreateSubmitBatcher(Device* _pDevice) {
+            pDevice = _pDevice;
+
+            queueSubmit2 = nullptr;
+
+            if(pDevice->isSynchronization2Enabled()) {
+                queueSubmit2 = reinterpret_cast<PFN_vkQueueSubmit2KHR>(vkGetDeviceProcAddr(*pDevice->getLogicalDevicePtr(), "vkQueueSubmit2KHR"));
+            }
+        }
+
+        /**
+         * @brief Queue command buffers for next Flush, thread-safe
+         * 
+         * @param request command buffers, wait semaphores with stages and signal semaphores for queue
+         */
+        void Submit(SubmitRequest request) {
+            submits.Push(std::move(request));
+        }
+
+        /**
+         * @brief Queue swapchain image for present after next Flush, thread-safe
+         * 
+         * @param request
+         */
+        void Present(PresentRequest request) {
+            presents.Push(std::move(request));
+        }
+
+        /**
+         * @brief Submit all queued requests and present all queued images, call once per frame from one thread
+         * 
+         * @param fence signaled when batches on all queues complete, one per frame in flight (VK_NULL_HANDLE for none)
+         * @return VkResult first error, else VK_SUBOPTIMAL_KHR if any present was suboptimal, else VK_SUCCESS
+         */
+        VkResult Flush(VkFence fence = VK_NULL_HANDLE) {
+            VG_PROFILE_FUNCTION();
+
+            VkResult result = VK_SUCCESS;
+
+            pending.clear();
+
+            SubmitRequest request;
+
+            while(submits.Pop(request)) {
+                pending.push_back(std::move(request));
+            }
+
+            if(!pending.empty()) {
+                SortRequests(pending, order);
+
+                std::vector<std::pair<uint32_t, uint32_t>> runs;
+                std::map<VkQueue, uint32_t> lastRuns;
+
+                for(uint32_t first = 0; first < order.size();) {
+                    uint32_t last = first + 1;
+
+                    while(last < order.size() && pending[order[last]].queue == pending[order[first]].queue) {
+                        last++;
+                    }
+
+                    lastRuns[pending[order[first]].queue] = runs.size();
+                    runs.push_back({first, last});
+
+                    first = last;
+                }
+
+                // Fence covers only its own queue, so last runs of other queues signal semaphores that one more submit waits for
+                VkQueue fenceQueue = pending[order.back()].queue;
+                bool joinQueues = fence != VK_NULL_HANDLE && lastRuns.size() > 1;
+
+                std::vector<VkSemaphore> joinWaits;
+
+                for(uint32_t r = 0; r < runs.size(); r++) {
+                    VkQueue queue = pending[order[runs[r].first]].queue;
+                    VkSemaphore joinSemaphore = VK_NULL_HANDLE;
+
+                    if(joinQueues && queue != fenceQueue && lastRuns[queue] == r) {
+                        joinSemaphore = getJoinSemaphore(fence, queue);
+                        joinWaits.push_back(joinSemaphore);
+                    }
+
+                    VkResult runResult = submitRun(runs[r].first, runs[r].second, joinSemaphore, !joinQueues && r == runs.size() - 1 ? fence : VK_NULL_HANDLE);
+
+                    if(runResult != VK_SUCCESS && result == VK_SUCCESS) {
+                        result = runResult;
+                    }
+                }
+
+                if(joinQueues) {
+                    std::vector<VkPipelineStageFlags> joinStages(joinWaits.size(), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+
+                    VkSubmitInfo joinInfo{VK_STRUCTURE_TYPE_SUBMIT_INFO};
+                    joinInfo.waitSemaphoreCount = joinWaits.size();
+                    joinInfo.pWaitSemaphores = joinWaits.data();
+                    joinInfo.pWaitDstStageMask = joinStages.data();
+
+                    VkResult joinResult = vkQueueSubmit(fenceQueue, 1, &joinInfo, fence);
+
+                    if(joinResult != VK_SUCCESS && result == VK_SUCCESS) {
+                        result = joinResult;
+                    }
+                }
+            }
+            else if(fence != VK_NULL_HANDLE) {
+                // keep fence usable for frame pacing even on frame without work
+                vkQueueSubmit(*pDevice->getGraphicsQueuePtr(), 0, nullptr, fence);
+            }
+
+            // Swapchain can be in one present call only once, so its next request on same queue goes to next call
+            std::map<VkQueue, std::vector<std::vector<PresentRequest>>> presentGroups;
+            std::map<std::pair<VkQueue, Swapchain*>, size_t> swapchainPresents;
+
+            PresentRequest presentRequest;
+
+            while(presents.Pop(presentRequest)) {
+                size_t& call = swapchainPresents[{presentRequest.queue, presentRequest.pSwapchain}];
+                auto& calls = presentGroups[presentRequest.queue];
+
+                if(calls.size() <= call) {
+                    calls.resize(call + 1);
+                }
+
+                calls[call++].push_back(presentRequest);
+            }
+
+            for(auto& [queue, calls] : presentGroups) {
+                for(auto& group : calls) {
+                    std::vector<VkSwapchainKHR> swapchains;
+                    std::vector<uint32_t> imageIndices;
+                    std::vector<uint64_t> presentIds;
+                    std::vector<VkSemaphore> waitSemaphores;
+                    std::vector<VkResult> presentResults(group.size(), VK_SUCCESS);
+
+                    for(const PresentRequest& present : group) {
+                        swapchains.push_back(*present.pSwapchain->getSwapchainPtr());
+                        imageIndices.push_back(present.imageIndex);
+                        presentIds.push_back(present.pSwapchain->getNextPresentId());
+
+                        if(present.waitSemaphore != VK_NULL_HANDLE) {
+                            waitSemaphores.push_back(present.waitSemaphore);
+                        }
+                    }
+
+                    VkPresentIdKHR presentIdInfo{VK_STRUCTURE_TYPE_PRESENT_ID_KHR};
+                    presentIdInfo.swapchainCount = presentIds.size();
+                    presentIdInfo.pPresentIds = presentIds.data();
+
+                    VkPresentInfoKHR presentInfo{VK_STRUCTURE_TYPE_PRESENT_INFO_KHR};
+                    presentInfo.pNext = pDevice->isPresentWaitEnabled() ? &presentIdInfo : nullptr;
+                    presentInfo.waitSemaphoreCount = waitSemaphores.size();
+                    presentInfo.pWaitSemaphores = waitSemaphores.data();
+                    presentInfo.swapchainCount = swapchains.size();
+                    presentInfo.pSwapchains = swapchains.data();
+                    presentInfo.pImageIndices = imageIndices.data();
+                    presentInfo.pResults = presentResults.data();
+
+                    VG_PROFILE_ZONE("vkQueuePresentKHR");
+                    vkQueuePresentKHR(queue, &presentInfo);
+
+                    for(size_t i = 0; i < group.size(); i++) {
+                        VkResult presentResult = presentResults[i];
+
+                        group[i].pSwapchain->OnPresented(presentIds[i], presentResult);
+
+                        if(presentResult == VK_SUBOPTIMAL_KHR && result == VK_SUCCESS) {
+                            result = presentResult;
+                        }
+                        else if(presentResult < 0 && result >= 0) {
+                            result = presentResult;
+                        }
+                    }
+                }
+            }
+
+            return result;
+        }
+    };
+
+    typedef Vg_SubmitBatcher SubmitBatcher;
+}
@@ -6,25 +6,61 @@
 #endif
 
 #include <limits>
+#include <array>
 #include <algorithm>
+#include <chrono>
+#include <deque>
+#include <thread>
 
 namespace vg {
+    /**
+     * @brief Trade between throughput and input-to-photon latency, picks present mode, images count and frame pacing
+     * 
+     * LowLatency waits until previous frame is on screen before next one starts,
+     * PowerSave also does that with FIFO and sleeps so frames start at most once per frame interval (refresh interval by default)
+     */
+    enum class PresentPolicy {
+        LowLatency,
+        MaxThroughput,
+        PowerSave
+    };
+
     class Vg_Swapchain {
     private:
-        VkSwapchainKHR swapchain;
+        SwapchainHandle swapchain;
         VkFormat s_format;
         VkExtent2D s_extent;
-        VkRenderPass rederPass;
+        RenderPassHandle renderPass;
 
-        VkImage depthImage;
-        VkImageView depthView;
-        VkDeviceMemory depthMemory;
-        std::vector<VkFramebuffer> swapchainFramebuffers;
+        bool keepDepth = false;
+        VkFormat depthFormat;
+        DeviceMemoryHandle depthMemory;
+        ImageHandle depthImage;
+        ImageViewHandle depthView;
 
+        // Images are owned by swapchain
         std::vector<VkImage> swapchainImages;
-        std::vector<VkImageView> swapchainImageViews;
+        std::vector<ImageViewHandle> swapchainImageViews;
+        std::vector<FramebufferHandle> swapchainFramebuffers;
         
-        Device* pDevice;
+        // Not owned, Device has to outlive Swapchain
+        Device* pDevice = nullptr;
+
+        PresentPolicy presentPolicy = PresentPolicy::MaxThroughput;
+        VkPresentModeKHR s_presentMode;
+
+        PFN_vkWaitForPresentKHR waitForPresent = nullptr;
+        uint64_t lastPresentId = 0;
+        std::deque<std::pair<uint64_t, std::chrono::steady_clock::time_point>> pendingPresents;
+        std::chrono::steady_clock::time_point frameStart;
+        double lastFrameLatency = 0.0;
+        double averageFrameLatency = 0.0;
+
+        // Refresh interval is estimated from completion times of consecutive presents that PaceFrame waited for
+        uint64_t lastCompletedId = 0;
+        std::chrono::steady_clock::time_point lastCompletion;
+        double refreshInterval = 0.0;
+        double frameInterval = 0.0;
 
         VkSurfaceFormatKHR chooseFormat(std::vector<VkSurfaceFormatKHR>& formats) {
             for(const auto& format : formats) {
@@ -36,16 +72,61 @@ namespace vg {
             return formats[0];
         }
 
-        VkPresentModeKHR choosePresentMode(std::vector<VkPresentModeKHR>& presentModes) {
-            for(const auto& presentMode : presentModes) {
-                if(presentMode == VK_PRESENT_MODE_MAILBOX_KHR) {
-                    return presentMode;
+        VkPresentModeKHR choosePresentMode(std::vector<VkPresentModeKHR>& presentModes, PresentPolicy policy) {
+            std::vector<VkPresentModeKHR> preferred;
+
+            switch(policy) {
+                case PresentPolicy::LowLatency:
+                    preferred = {VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR};
+                    break;
+
+                case PresentPolicy::MaxThroughput:
+                    preferred = {VK_PRESENT_MODE_MAILBOX_KHR};
+                    break;
+
+                case PresentPolicy::PowerSave:
+                    break;
+            }
+
+            for(const auto& mode : preferred) {
+                for(const auto& presentMode : presentModes) {
+                    if(presentMode == mode) {
+                        return presentMode;
+                    }
                 }
             }
 
+            // FIFO is the only mode that is always supported
             return VK_PRESENT_MODE_FIFO_KHR;
         }
 
+        uint32_t chooseImagesCount(VkSurfaceCapabilitiesKHR& capabilities, VkPresentModeKHR presentMode, PresentPolicy policy) {
+            uint32_t imagesCount = capabilities.minImageCount + 1;
+
+            // Less images in queue means less frames between input and screen, MAILBOX still needs spare image to not block
+            if(policy == PresentPolicy::LowLatency && presentMode != VK_PRESENT_MODE_MAILBOX_KHR) {
+                imagesCount = capabilities.minImageCount;
+            }
+
+            if(capabilities.maxImageCount > 0 && capabilities.maxImageCount < imagesCount) {
+                imagesCount = capabilities.maxImageCount;
+            }
+
+            return imagesCount;
+        }
+
+        uint64_t framesAhead() {
+            switch(presentPolicy) {
+                case PresentPolicy::LowLatency:
+                case PresentPolicy::PowerSave:
+                    return 1;
+
+                case PresentPolicy::MaxThroughput:
+                default:
+                    return 0;
+            }
+        }
+
         VkExtent2D chooseExtent(VkSurfaceCapabilitiesKHR& capabilities, int width, int height) {
             if(capabilities.currentExtent.width != std::numeric_limits<uint32_t>::max()) {
                 return capabilities.currentExtent;
@@ -78,31 +159,54 @@ namespace vg {
 
             std::cerr << "Wrong formats and features!\n";
 
+            VG_PROFILE_EXIT(10);
             exit(10);
         }
 
         VkFormat findDepthFormat() {
-            return findSupportedFormat({VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT}, VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
+            VkFormatFeatureFlags features = VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT;
+
+            if(keepDepth) {
+                features |= VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT;
+            }
+
+            return findSupportedFormat({VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT}, VK_IMAGE_TILING_OPTIMAL, features);
         }
 
     public:
-        int CreateSwapchain(Device* _pDevice, int width, int height) {
+        // Members are declared so implicit destruction releases framebuffers and views before render pass and swapchain
+        Vg_Swapchain() = default;
+        Vg_Swapchain(const Vg_Swapchain&) = delete;
+        Vg_Swapchain& operator=(const Vg_Swapchain&) = delete;
+        // std::deque move may allocate, it's only out of memory that can throw there
+        Vg_Swapchain(Vg_Swapchain&&) noexcept = default;
+        Vg_Swapchain& operator=(Vg_Swapchain&&) = default;
+
+        /**
+         * @brief Create a Swapchain
+         * 
+         * @param _pDevice pointer to created Device
+         * @param width framebuffer width
+         * @param height framebuffer height
+         * @param policy presentation policy, decides present mode, images count and frame pacing
+         * @return int 
+         */
+        int CreateSwapchain(Device* _pDevice, int width, int height, PresentPolicy policy = PresentPolicy::MaxThroughput) {
+            VG_PROFILE_FUNCTION();
+
             pDevice = _pDevice;
+            presentPolicy = policy;
 
             SwapchainSupportDetails details = pDevice->querySwapchainSupport();
 
             VkSurfaceFormatKHR swapchainFormat = chooseFormat(details.formats);
-            VkPresentModeKHR swapchainPresentMode = choosePresentMode(details.presentModes);
+            VkPresentModeKHR swapchainPresentMode = choosePresentMode(details.presentModes, presentPolicy);
             VkExtent2D swapchainExtent = chooseExtent(details.capabilities, width, height);
 
-            uint32_t imagesCount = details.capabilities.minImageCount + 1;
-
-            if(details.capabilities.maxImageCount > 0 && details.capabilities.maxImageCount < imagesCount) {
-                imagesCount = details.capabilities.maxImageCount;
-            }
+            uint32_t imagesCount = chooseImagesCount(details.capabilities, swapchainPresentMode, presentPolicy);
 
             VkSwapchainCreateInfoKHR swapchainInfo{VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR};
-            swapchainInfo.surface = pDevice->getInstancePtr()->presentSurface;
+            swapchainInfo.surface = pDevice->getInstancePtr()->getPresentSurface();
             swapchainInfo.minImageCount = imagesCount;
             swapchainInfo.imageFormat = swapchainFormat.format;
             swapchainInfo.imageColorSpace = swapchainFormat.colorSpace;
@@ -133,71 +237,272 @@ namespace vg {
 
             swapchainInfo.oldSwapchain = VK_NULL_HANDLE;
 
-            if(vkCreateSwapchainKHR(*pDevice->getLogicalDevicePtr(), &swapchainInfo, nullptr, &swapchain) != VK_SUCCESS) {
+            if(vkCreateSwapchainKHR(*pDevice->getLogicalDevicePtr(), &swapchainInfo, nullptr, swapchain.put({*pDevice->getLogicalDevicePtr()})) != VK_SUCCESS) {
                 std::cerr << "Cannot create swapchain!\n";
 
+                VG_PROFILE_EXIT(7);
                 exit(7);
             }
 
-            vkGetSwapchainImagesKHR(*pDevice->getLogicalDevicePtr(), swapchain, &imagesCount, nullptr);
+            vkGetSwapchainImagesKHR(*pDevice->getLogicalDevicePtr(), swapchain.get(), &imagesCount, nullptr);
 
             swapchainImages.resize(imagesCount);
-            vkGetSwapchainImagesKHR(*pDevice->getLogicalDevicePtr(), swapchain, &imagesCount, swapchainImages.data());
+            vkGetSwapchainImagesKHR(*pDevice->getLogicalDevicePtr(), swapchain.get(), &imagesCount, swapchainImages.data());
 
             s_format = swapchainFormat.format;
             s_extent = swapchainExtent;
-        }
+            s_presentMode = swapchainPresentMode;
 
-        void RecreateSwapchain(int width, int height) {
-            vkDeviceWaitIdle(*pDevice->getLogicalDevicePtr());
+            // Present ids are counted per swapchain
+            lastPresentId = 0;
+            lastCompletedId = 0;
+            refreshInterval = 0.0;
+            pendingPresents.clear();
+            frameStart = std::chrono::steady_clock::now();
 
-            CleanSwapchain();
+            waitForPresent = nullptr;
+
+            if(pDevice->isPresentWaitEnabled()) {
+                waitForPresent = (PFN_vkWaitForPresentKHR)vkGetDeviceProcAddr(*pDevice->getLogicalDevicePtr(), "vkWaitForPresentKHR");
+            }
+
+            return 0;
         }
 
-        VkImageView CreateImageView(VkImage image, VkFormat format, VkImageAspectFlags imageAspectFlags) {
-            VkImageViewCreateInfo imgViewInfo{VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO};
-            imgViewInfo.image = image;
-            imgViewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-            imgViewInfo.format = format;
-            imgViewInfo.subresourceRange.aspectMask = imageAspectFlags;
-            imgViewInfo.subresourceRange.baseMipLevel = 0;
-            imgViewInfo.subresourceRange.levelCount = 1;
-            imgViewInfo.subresourceRange.baseArrayLayer = 0;
-            imgViewInfo.subresourceRange.layerCount = 1;
+        /**
+         * @brief Wait until frames queued for presentation fit in present policy (call before acquiring image and reading input).
+         * Also collects per-frame latency from presents it had to wait for. Does nothing without VK_KHR_present_wait,
+         * except PowerSave sleep when frame interval was set
+         * 
+         */
+        void PaceFrame() {
+            VG_PROFILE_FUNCTION();
+
+            if(waitForPresent != nullptr) {
+                uint64_t ahead = framesAhead();
+                uint64_t target = 0;
+
+                if(ahead > 0 && lastPresentId >= ahead) {
+                    target = lastPresentId + 1 - ahead;
+                }
 
-            VkImageView imageView;
+                while(!pendingPresents.empty()) {
+                    uint64_t id = pendingPresents.front().first;
+
+                    VG_PROFILE_ZONE("vkWaitForPresentKHR");
+                    VkResult result = waitForPresent(*pDevice->getLogicalDevicePtr(), swapchain.get(), id, 0);
+                    bool waited = false;
+
+                    // Block only for presents that policy needs on screen, rest is polled
+                    if(result == VK_TIMEOUT && id <= target) {
+                        result = waitForPresent(*pDevice->getLogicalDevicePtr(), swapchain.get(), id, 1000000000ull);
+                        waited = true;
+                    }
+
+                    if(result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR) {
+                        // Polled present was done at unknown moment before now, only blocking wait returns at completion
+                        if(waited) {
+                            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+                            std::chrono::duration<double, std::milli> latency = now - pendingPresents.front().second;
+
+                            lastFrameLatency = latency.count();
+                            averageFrameLatency = averageFrameLatency == 0.0 ? lastFrameLatency : averageFrameLatency * 0.9 + lastFrameLatency * 0.1;
+
+                            if(lastCompletedId != 0 && id == lastCompletedId + 1 && s_presentMode == VK_PRESENT_MODE_FIFO_KHR) {
+                                double interval = std::chrono::duration<double, std::milli>(now - lastCompletion).count();
+
+                                if(interval >= 1.0 && (refreshInterval == 0.0 || interval < refreshInterval)) {
+                                    refreshInterval = interval;
+                                }
+                            }
+
+                            lastCompletedId = id;
+                            lastCompletion = now;
+                        }
+
+                        pendingPresents.pop_front();
+                    }
+                    else if(result == VK_TIMEOUT) {
+                        break;
+                    }
+                    else {
+                        // Out of date or lost surface, ids of this swapchain won't be presented anymore
+                        pendingPresents.clear();
+                    }
+                }
+            }
 
-            if(vkCreateImageView(*pDevice->getLogicalDevicePtr(), &imgViewInfo, nullptr, &imageView) != VK_SUCCESS) {
-                std::cerr << "Cannot create image view!\n";
+            if(presentPolicy == PresentPolicy::PowerSave) {
+                double interval = frameInterval > 0.0 ? frameInterval : refreshInterval;
 
-                exit(8);
+                if(interval > 0.0) {
+                    VG_PROFILE_ZONE("PowerSave sleep");
+                    std::this_thread::sleep_until(frameStart + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::milli>(interval)));
+                }
             }
 
-            return imageView;
+            frameStart = std::chrono::steady_clock::now();
         }
 
-        void CleanSwapchain() {
-            vkDestroyImageView(*pDevice->getLogicalDevicePtr(), depthView, nullptr);
-            vkDestroyImage(*pDevice->getLogicalDevicePtr(), depthImage, nullptr);
-            vkFreeMemory(*pDevice->getLogicalDevicePtr(), depthMemory, nullptr);
+        /**
+         * @brief Present swapchain image on present queue, tags it with present id when VK_KHR_present_wait is enabled
+         * 
+         * @param imageIndex index of acquired image
+         * @param waitSemaphore semaphore signaled when rendering is finished
+         * @return VkResult of vkQueuePresentKHR
+         */
+        VkResult Present(uint32_t imageIndex, VkSemaphore waitSemaphore) {
+            VG_PROFILE_FUNCTION();
 
-            for(auto fb : swapchainFramebuffers) {
-                vkDestroyFramebuffer(*pDevice->getLogicalDevicePtr(), fb, nullptr);
-            }
+            uint64_t presentId = lastPresentId + 1;
+
+            VkPresentIdKHR presentIdInfo{VK_STRUCTURE_TYPE_PRESENT_ID_KHR};
+            presentIdInfo.swapchainCount = 1;
+            presentIdInfo.pPresentIds = &presentId;
+
+            VkPresentInfoKHR presentInfo{VK_STRUCTURE_TYPE_PRESENT_INFO_KHR};
+            presentInfo.pNext = waitForPresent != nullptr ? &presentIdInfo : nullptr;
+            presentInfo.waitSemaphoreCount = waitSemaphore != VK_NULL_HANDLE ? 1 : 0;
+            presentInfo.pWaitSemaphores = &waitSemaphore;
+            presentInfo.swapchainCount = 1;
+            presentInfo.pSwapchains = swapchain.getPtr();
+            presentInfo.pImageIndices = &imageIndex;
+
+            VkResult result = vkQueuePresentKHR(*pDevice->getPresentQueuePtr(), &presentInfo);
+
+            OnPresented(waitForPresent != nullptr ? presentId : 0, result);
+
+            return result;
+        }
 
-            for(auto iv : swapchainImageViews) {
-                vkDestroyImageView(*pDevice->getLogicalDevicePtr(), iv, nullptr);
+        /**
+         * @brief Get id to tag next present of this swapchain with (VkPresentIdKHR)
+         * 
+         * @return uint64_t 0 when VK_KHR_present_wait is not enabled and presents shouldn't be tagged
+         */
+        uint64_t getNextPresentId() { return waitForPresent != nullptr ? lastPresentId + 1 : 0; }
+
+        /**
+         * @brief Report present of this swapchain made outside of Present (eg. by Vg_SubmitBatcher), so PaceFrame can wait for it
+         * 
+         * @param presentId id from getNextPresentId the present was tagged with
+         * @param result result of present of this swapchain
+         */
+        void OnPresented(uint64_t presentId, VkResult result) {
+            if(presentId != 0 && (result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR)) {
+                lastPresentId = presentId;
+                pendingPresents.push_back({presentId, frameStart});
             }
+        }
+
+        /**
+         * @brief Get time in milliseconds between PaceFrame and moment when that frame was presented.
+         * Only presents PaceFrame waited for are measured, so it stays 0 with MaxThroughput or without VK_KHR_present_wait
+         * 
+         * @return double 
+         */
+        double getLastFrameLatency() { return lastFrameLatency; }
+
+        /**
+         * @brief Get smoothed frame latency in milliseconds
+         * 
+         * @return double 
+         */
+        double getAverageFrameLatency() { return averageFrameLatency; }
+
+        /**
+         * @brief Set minimum time between frame starts of PowerSave policy, 0 uses estimated refresh interval
+         * 
+         * @param milliseconds eg. 33.3 for 30 frames per second
+         */
+        void setFrameInterval(double milliseconds) { frameInterval = milliseconds; }
+
+        /**
+         * @brief Get refresh interval in milliseconds estimated from FIFO presents (0 until two consecutive presents were waited for)
+         * 
+         * @return double 
+         */
+        double getRefreshInterval() { return refreshInterval; }
+
+        /**
+         * @brief Get the Present Policy used to create swapchain
+         * 
+         * @return PresentPolicy 
+         */
+        PresentPolicy getPresentPolicy() { return presentPolicy; }
+
+        /**
+         * @brief Get the Present Mode chosen for present policy
+         * 
+         * @return VkPresentModeKHR 
+         */
+        VkPresentModeKHR getPresentMode() { return s_presentMode; }
+
+        void RecreateSwapchain(int width, int height) {
+            VG_PROFILE_FUNCTION();
+
+            vkDeviceWaitIdle(*pDevice->getLogicalDevicePtr());
+
+            CleanSwapchain();
+        }
 
-            vkDestroySwapchainKHR(*pDevice->getLogicalDevicePtr(), swapchain, nullptr);
+        /**
+         * @brief Create image view, see Vg_Device::CreateImageView
+         * 
+         * @return VkImageView 
+         */
+        VkImageView CreateImageView(VkImage image, VkFormat format, VkImageAspectFlags imageAspectFlags, uint32_t baseMipLevel = 0, uint32_t mipLevels = 1, uint32_t baseArrayLayer = 0, uint32_t layerCount = 1, VkImageViewType viewType = VK_IMAGE_VIEW_TYPE_2D) {
+            return pDevice->CreateImageView(image, format, imageAspectFlags, baseMipLevel, mipLevels, baseArrayLayer, layerCount, viewType);
+        }
+
+        /**
+         * @brief Destroy swapchain and resources sized by it (render pass is kept), safe to call more than once
+         * 
+         */
+        void CleanSwapchain() {
+            depthView.reset();
+            depthImage.reset();
+            depthMemory.reset();
+
+            swapchainFramebuffers.clear();
+            swapchainImageViews.clear();
+            swapchainImages.clear();
+
+            swapchain.reset();
         }
 
         void CreateImageViews() {
-            swapchainImageViews.resize(swapchainImages.size());
+            swapchainImageViews.clear();
+            swapchainImageViews.reserve(swapchainImages.size());
 
             for (size_t i = 0; i < swapchainImages.size(); i++) {
-                swapchainImageViews[i] = CreateImageView(swapchainImages[i], s_format, VK_IMAGE_ASPECT_COLOR_BIT);
+                swapchainImageViews.push_back(ImageViewHandle(CreateImageView(swapchainImages[i], s_format, VK_IMAGE_ASPECT_COLOR_BIT), {*pDevice->getLogicalDevicePtr()}));
+            }
+        }
+
+        /**
+         * @brief Create depth image, memory and view with swapchain extent
+         * 
+         */
+        void CreateDepthResources() {
+            depthFormat = findDepthFormat();
+
+            VkImageUsageFlags usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+
+            if(keepDepth) {
+                usage |= VK_IMAGE_USAGE_SAMPLED_BIT;
             }
+
+            VkDevice device = *pDevice->getLogicalDevicePtr();
+
+            VkImage image;
+            VkDeviceMemory memory;
+
+            pDevice->CreateImage(s_extent.width, s_extent.height, 1, 1, depthFormat, VK_IMAGE_TILING_OPTIMAL, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image, memory);
+
+            depthMemory = DeviceMemoryHandle(memory, {device});
+            depthImage = ImageHandle(image, {device});
+            depthView = ImageViewHandle(CreateImageView(image, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT), {device});
         }
 
         void CreateRenderPass() {
@@ -213,13 +518,14 @@ namespace vg {
 
             VkAttachmentDescription depthAttachmentDescriptor{};
             depthAttachmentDescriptor.format = findDepthFormat();
-            depthAttachemntDescriptor.samples = VK_SAMPLE_COUNT_1_BIT;
-            depthAttachemntDescriptor.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-            depthAttachemntDescriptor.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-            depthAttachemntDescriptor.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-            depthAttachemntDescriptor.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-            depthAttachemntDescriptor.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-            depthAttachemntDescriptor.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL
+            depthAttachmentDescriptor.samples = VK_SAMPLE_COUNT_1_BIT;
+            depthAttachmentDescriptor.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+            // Depth is only stored when something reads it in next frame (eg. Vg_HiZ)
+            depthAttachmentDescriptor.storeOp = keepDepth ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            depthAttachmentDescriptor.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+            depthAttachmentDescriptor.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            depthAttachmentDescriptor.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            depthAttachmentDescriptor.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
             VkAttachmentReference colorAttachmentReference{};
             colorAttachmentReference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
@@ -249,19 +555,67 @@ namespace vg {
             renderPassInfo.attachmentCount = attachmentDescriptors.size();
             renderPassInfo.pAttachments = attachmentDescriptors.data();
             renderPassInfo.subpassCount = 1;
-            renderPassInfo.pSubpasses = &subpass;
+            renderPassInfo.pSubpasses = &subpassDescriptor;
             renderPassInfo.dependencyCount = 1;
             renderPassInfo.pDependencies = &subpassDependency;
 
-            if(vkCreateRenderPass(*pDevice->getLogicalDevicePtr(), &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS) {
+            if(vkCreateRenderPass(*pDevice->getLogicalDevicePtr(), &renderPassInfo, nullptr, renderPass.put({*pDevice->getLogicalDevicePtr()})) != VK_SUCCESS) {
                 std::cerr << "Cannot create render pass!\n";
 
+                VG_PROFILE_EXIT(11);
                 exit(11);
             }
         }
 
-        ~Vg_Swapchain() {
-            CleanSwapchain();
-        }
+        /**
+         * @brief Store depth at end of render pass and make it sampleable, call before CreateDepthResources and CreateRenderPass
+         * 
+         * @param keep 
+         */
+        void setKeepDepth(bool keep) { keepDepth = keep; }
+
+        /**
+         * @brief Get the Swapchain Ptr
+         * 
+         * @return const VkSwapchainKHR* 
+         */
+        const VkSwapchainKHR* getSwapchainPtr() { return swapchain.getPtr(); }
+
+        /**
+         * @brief Get the Render Pass Ptr
+         * 
+         * @return const VkRenderPass* 
+         */
+        const VkRenderPass* getRenderPassPtr() { return renderPass.getPtr(); }
+
+        /**
+         * @brief Get the Extent of swapchain images
+         * 
+         * @return VkExtent2D 
+         */
+        VkExtent2D getExtent() { return s_extent; }
+
+        /**
+         * @brief Get the Depth Format
+         * 
+         * @return VkFormat 
+         */
+        VkFormat getDepthFormat() { return depthFormat; }
+
+        /**
+         * @brief Get the Depth Image Ptr
+         * 
+         * @return const VkImage* 
+         */
+        const VkImage* getDepthImagePtr() { return depthImage.getPtr(); }
+
+        /**
+         * @brief Get the Depth View Ptr
+         * 
+         * @return const VkImageView* 
+         */
+        const VkImageView* getDepthViewPtr() { return depthView.getPtr(); }
     };
+
+    typedef Vg_Swapchain Swapchain;
 }
\ No newline at end of file
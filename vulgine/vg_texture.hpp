@@ -0,0 +1,485 @@
+#pragma once
+#define VG_TEXTURE 1
+
+#ifndef VG_DEVICES
+#include "vg_devices.hpp"
+#endif
+
+#ifndef VG_FILE
+#include "vg_file.hpp"
+#endif
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+namespace vg {
+    const uint8_t ktx2Identifier[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+    struct Ktx2Header {
+        uint8_t identifier[12];
+        uint32_t vkFormat;
+        uint32_t typeSize;
+        uint32_t pixelWidth;
+        uint32_t pixelHeight;
+        uint32_t pixelDepth;
+        uint32_t layerCount;
+        uint32_t faceCount;
+        uint32_t levelCount;
+        uint32_t supercompressionScheme;
+        uint32_t dfdByteOffset;
+        uint32_t dfdByteLength;
+        uint32_t kvdByteOffset;
+        uint32_t kvdByteLength;
+        uint64_t sgdByteOffset;
+        uint64_t sgdByteLength;
+    };
+
+    struct Ktx2LevelIndex {
+        uint64_t byteOffset;
+        uint64_t byteLength;
+        uint64_t uncompressedByteLength;
+    };
+
+    /**
+     * @brief Memory mapped KTX2 texture (also block-compressed formats), mip levels are uploaded by Vg_TextureStreamer.
+     * View covers only uploaded levels and is recreated when streamer adds finer ones, update descriptors when getViewVersion() changes
+     * 
+     */
+    class Vg_Texture {
+    private:
+        friend class Vg_TextureStreamer;
+
+        Device* pDevice = nullptr;
+
+        MappedFile file;
+        std::vector<Ktx2LevelIndex> levels;
+
+        DeviceMemoryHandle memory;
+        ImageHandle image;
+        ImageViewHandle view;
+        VkImageViewType viewType;
+        VkFormat format;
+
+        // Views replaced by finer ones with streamer update count, frames in flight still may sample them
+        std::vector<std::pair<uint64_t, ImageViewHandle>> retiredViews;
+        uint32_t viewVersion = 0;
+
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t levelCount = 0;
+        uint32_t layerCount = 0;
+
+        // Bytes of one texel block (bytesPlane0 of KTX2 data format descriptor), staging offsets must be its multiple
+        uint32_t blockSize = 0;
+
+        uint32_t residentLevel = 0;
+        uint32_t desiredLevel = 0;
+        float demand = 1.0f;
+        bool layoutReady = false;
+
+    public:
+        /**
+         * @brief Map KTX2 file and create image with all mip levels and layers, no texel data is uploaded yet
+         * 
+         * @param _pDevice pointer to created Device
+         * @param path path to .ktx2 file
+         * @return int 0 on success, 1 when file cannot be mapped, 2 when file is not valid KTX2, 3 when texture is not supported
+         */
+        int Open(Device* _pDevice, const std::string& path) {
+            pDevice = _pDevice;
+
+            if(file.Open(path) != 0) {
+                return 1;
+            }
+
+            Ktx2Header header;
+
+            if(file.getSize() < sizeof(Ktx2Header) || memcmp(file.getData(), ktx2Identifier, sizeof(ktx2Identifier)) != 0) {
+                std::cerr << "Invalid KTX2 file " << path << "!\n";
+
+                return 2;
+            }
+
+            memcpy(&header, file.getData(), sizeof(Ktx2Header));
+
+            // Supercompressed and Basis Universal (VK_FORMAT_UNDEFINED) payloads need transcoding
+            if(header.supercompressionScheme != 0 || header.vkFormat == VK_FORMAT_UNDEFINED || header.pixelDepth > 1 || (header.faceCount != 1 && header.faceCount != 6)) {
+                std::cerr << "Unsupported KTX2 texture " << path << "!\n";
+
+                return 3;
+            }
+
+            width = header.pixelWidth;
+            height = std::max(header.pixelHeight, 1u);
+            levelCount = std::max(header.levelCount, 1u);
+            layerCount = std::max(header.layerCount, 1u) * header.faceCount;
+            format = (VkFormat)header.vkFormat;
+
+            if(file.getSize() < sizeof(Ktx2Header) + levelCount * sizeof(Ktx2LevelIndex)) {
+                std::cerr << "Invalid KTX2 file " << path << "!\n";
+
+                return 2;
+            }
+
+            // Basic data format descriptor block follows total size word, bytesPlane0 is first byte of its 5th word
+            const uint32_t dfdBlockSizeOffset = 20;
+
+            if(header.dfdByteLength <= dfdBlockSizeOffset || (uint64_t)header.dfdByteOffset + header.dfdByteLength > file.getSize()) {
+                std::cerr << "Invalid KTX2 file " << path << "!\n";
+
+                return 2;
+            }
+
+            blockSize = file.getData()[header.dfdByteOffset + dfdBlockSizeOffset];
+
+            if(blockSize == 0) {
+                std::cerr << "Unsupported KTX2 texture " << path << "!\n";
+
+                return 3;
+            }
+
+            levels.resize(levelCount);
+            memcpy(levels.data(), file.getData() + sizeof(Ktx2Header), levelCount * sizeof(Ktx2LevelIndex));
+
+            for(const auto& level : levels) {
+                if(level.byteOffset + level.byteLength > file.getSize()) {
+                    std::cerr << "Invalid KTX2 file " << path << "!\n";
+
+                    return 2;
+                }
+            }
+
+            VkFormatProperties props;
+            vkGetPhysicalDeviceFormatProperties(*pDevice->getPhysicalDevicePtr(), format, &props);
+
+            if((props.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) == 0) {
+                std::cerr << "Texture format of " << path << " is not supported by device!\n";
+
+                return 3;
+            }
+
+            viewType = VK_IMAGE_VIEW_TYPE_2D;
+
+            if(header.faceCount == 6) {
+                viewType = header.layerCount > 1 ? VK_IMAGE_VIEW_TYPE_CUBE_ARRAY : VK_IMAGE_VIEW_TYPE_CUBE;
+            }
+            else if(header.layerCount > 0) {
+                viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+            }
+
+            // View is created by streamer with first uploaded level
+            retiredViews.clear();
+            view.reset();
+
+            pDevice->CreateImage(width, height, levelCount, layerCount, format, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image, memory, header.faceCount == 6 ? VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT : 0);
+
+            residentLevel = levelCount;
+            desiredLevel = 0;
+            layoutReady = false;
+
+            return 0;
+        }
+
+        /**
+         * @brief Set on-screen size of texture, decides which mip levels are needed and how urgent they are
+         * 
+         * @param pixels projected size of texture on screen in pixels (0 when not visible)
+         */
+        void setScreenSize(float pixels) {
+            demand = pixels;
+
+            if(pixels <= 0.0f) {
+                desiredLevel = levelCount - 1;
+
+                return;
+            }
+
+            float level = std::floor(std::log2((float)std::max(width, height) / pixels));
+
+            desiredLevel = (uint32_t)std::clamp(level, 0.0f, (float)(levelCount - 1));
+        }
+
+        /**
+         * @brief Check if at least coarsest mip level was uploaded
+         * 
+         * @return bool
+         */
+        bool isReady() { return residentLevel < levelCount; }
+
+        /**
+         * @brief Check if all levels needed by screen size were uploaded
+         * 
+         * @return bool
+         */
+        bool isComplete() { return residentLevel <= desiredLevel; }
+
+        uint32_t getLevelCount() { return levelCount; }
+        uint32_t getLayerCount() { return layerCount; }
+        uint32_t getResidentLevel() { return residentLevel; }
+        VkFormat getFormat() { return format; }
+
+        /**
+         * @brief Get the Image Ptr
+         * 
+         * @return const VkImage*
+         */
+        const VkImage* getImagePtr() { return image.getPtr(); }
+
+        /**
+         * @brief Get number of times view was recreated, descriptors using old view must be updated
+         * 
+         * @return uint32_t 
+         */
+        uint32_t getViewVersion() { return viewVersion; }
+
+        /**
+         * @brief Get the View Ptr (resident mip levels and all layers, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL), null until isReady()
+         * 
+         * @return const VkImageView*
+         */
+        const VkImageView* getViewPtr() { return view.getPtr(); }
+    };
+
+    typedef Vg_Texture Texture;
+
+    /**
+     * @brief Streams texture mip levels coarsest first through per-frame staging buffer, most demanded textures go first
+     * 
+     */
+    class Vg_TextureStreamer {
+    private:
+        /**
+         * @brief Staging buffer of mip level that doesn't fit to frame budget
+         * 
+         */
+        struct OversizedStaging {
+            DeviceMemoryHandle memory;
+            BufferHandle buffer;
+        };
+
+        Device* pDevice = nullptr;
+
+        // Memory stays mapped until it's freed, freeing unmaps it
+        DeviceMemoryHandle stagingMemory;
+        BufferHandle stagingBuffer;
+        uint8_t* pStaging = nullptr;
+
+        VkDeviceSize segmentSize = 0;
+        uint32_t framesInFlight = 1;
+        uint64_t updateCount = 0;
+
+        // Freed when same frame index is updated again
+        std::vector<std::vector<OversizedStaging>> oversizedStaging;
+
+        std::vector<Texture*> textures;
+
+        void levelBarrier(VkCommandBuffer commandBuffer, Texture* texture, uint32_t baseLevel, uint32_t levels, VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccess, VkAccessFlags dstAccess, VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage) {
+            VkImageMemoryBarrier barrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+            barrier.oldLayout = oldLayout;
+            barrier.newLayout = newLayout;
+            barrier.srcAccessMask = srcAccess;
+            barrier.dstAccessMask = dstAccess;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.image = texture->image.get();
+            barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            barrier.subresourceRange.baseMipLevel = baseLevel;
+            barrier.subresourceRange.levelCount = levels;
+            barrier.subresourceRange.baseArrayLayer = 0;
+            barrier.subresourceRange.layerCount = texture->layerCount;
+
+            vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+        }
+
+    public:
+        /**
+         * @brief Create persistently mapped staging buffer split into one segment per frame in flight
+         * 
+         * @param _pDevice pointer to created Device
+         * @param bytesPerFrame upload budget of one frame, bigger mip level is uploaded alone through temporary staging buffer
+         * @param _framesInFlight number of frames that can be in flight
+         */
+        void CreateTextureStreamer(Device* _pDevice, VkDeviceSize bytesPerFrame, uint32_t _framesInFlight) {
+            pDevice = _pDevice;
+            segmentSize = bytesPerFrame;
+            framesInFlight = std::max(_framesInFlight, 1u);
+
+            oversizedStaging.clear();
+            oversizedStaging.resize(framesInFlight);
+
+            pDevice->CreateBuffer(segmentSize * framesInFlight, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingMemory);
+
+            if(vkMapMemory(*pDevice->getLogicalDevicePtr(), stagingMemory.get(), 0, VK_WHOLE_SIZE, 0, (void**)&pStaging) != VK_SUCCESS) {
+                std::cerr << "Cannot map texture staging memory!\n";
+
+                VG_PROFILE_EXIT(32);
+                exit(32);
+            }
+        }
+
+        /**
+         * @brief Start streaming texture
+         * 
+         * @param texture opened texture, must outlive streamer or be removed
+         */
+        void AddTexture(Texture* texture) {
+            for(const auto& level : texture->levels) {
+                if(level.byteLength > segmentSize) {
+                    std::cerr << "Texture mip level is bigger than streaming budget, it will be uploaded alone in frame!\n";
+
+                    break;
+                }
+            }
+
+            textures.push_back(texture);
+        }
+
+        /**
+         * @brief Stop streaming texture
+         * 
+         * @param texture
+         */
+        void RemoveTexture(Texture* texture) {
+            textures.erase(std::remove(textures.begin(), textures.end(), texture), textures.end());
+        }
+
+        /**
+         * @brief Record uploads of next mip levels that fit in frame budget. Command buffer must be submitted before draws that use textures
+         * and segment of frameIndex must not be in use by GPU (fence of that frame waited). Call once per frame, views replaced
+         * framesInFlight calls ago are destroyed
+         * 
+         * @param commandBuffer command buffer outside of render pass
+         * @param frameIndex index of frame in flight
+         * @return uint32_t number of uploaded mip levels
+         */
+        uint32_t Update(VkCommandBuffer commandBuffer, uint32_t frameIndex) {
+            VG_PROFILE_FUNCTION();
+
+            uint32_t frameSlot = frameIndex % framesInFlight;
+
+            updateCount++;
+            oversizedStaging[frameSlot].clear();
+
+            for(auto texture : textures) {
+                auto& retired = texture->retiredViews;
+
+                retired.erase(std::remove_if(retired.begin(), retired.end(), [&](const auto& entry) { return updateCount - entry.first >= framesInFlight; }), retired.end());
+            }
+
+            std::vector<Texture*> pending;
+
+            for(auto texture : textures) {
+                if(texture->residentLevel > texture->desiredLevel) {
+                    pending.push_back(texture);
+                }
+            }
+
+            // Textures without any level go first, then the ones with biggest screen size and most missing levels
+            std::sort(pending.begin(), pending.end(), [](Texture* a, Texture* b) {
+                if(a->isReady() != b->isReady()) {
+                    return !a->isReady();
+                }
+
+                return a->demand * (a->residentLevel - a->desiredLevel) > b->demand * (b->residentLevel - b->desiredLevel);
+            });
+
+            VkDeviceSize segmentBase = frameSlot * segmentSize;
+            VkDeviceSize used = 0;
+            uint32_t uploaded = 0;
+
+            for(auto texture : pending) {
+                uint32_t previousResidentLevel = texture->residentLevel;
+
+                // Levels stay in transfer layout until uploaded, view never covers them, so they are not read before copy
+                if(!texture->layoutReady) {
+                    levelBarrier(commandBuffer, texture, 0, texture->levelCount, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                        0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+                    texture->layoutReady = true;
+                }
+
+                while(texture->residentLevel > texture->desiredLevel) {
+                    uint32_t level = texture->residentLevel - 1;
+                    const Ktx2LevelIndex& levelIndex = texture->levels[level];
+
+                    // Copies need buffer offsets aligned to texel block size (also 3 and 12 byte ones) and to 4, 16 keeps them cache friendly
+                    VkDeviceSize alignment = std::lcm((VkDeviceSize)16, (VkDeviceSize)texture->blockSize);
+                    VkDeviceSize offset = (segmentBase + used + alignment - 1) / alignment * alignment - segmentBase;
+
+                    VkBuffer source = stagingBuffer.get();
+                    VkDeviceSize sourceOffset = segmentBase + offset;
+                    uint8_t* pDestination = pStaging + sourceOffset;
+
+                    if(levelIndex.byteLength > segmentSize) {
+                        // Level never fits to budget, so it takes whole frame with own staging buffer
+                        if(used > 0) {
+                            break;
+                        }
+
+                        oversizedStaging[frameSlot].emplace_back();
+                        OversizedStaging& staging = oversizedStaging[frameSlot].back();
+
+                        pDevice->CreateBuffer(levelIndex.byteLength, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, staging.buffer, staging.memory);
+
+                        if(vkMapMemory(*pDevice->getLogicalDevicePtr(), staging.memory.get(), 0, VK_WHOLE_SIZE, 0, (void**)&pDestination) != VK_SUCCESS) {
+                            std::cerr << "Cannot map texture staging memory!\n";
+
+                            VG_PROFILE_EXIT(32);
+                            exit(32);
+                        }
+
+                        source = staging.buffer.get();
+                        sourceOffset = 0;
+                        used = segmentSize;
+                    }
+                    else if(offset + levelIndex.byteLength > segmentSize) {
+                        break;
+                    }
+                    else {
+                        used = offset + levelIndex.byteLength;
+                    }
+
+                    memcpy(pDestination, texture->file.getData() + levelIndex.byteOffset, levelIndex.byteLength);
+
+                    VkBufferImageCopy region{};
+                    region.bufferOffset = sourceOffset;
+                    region.bufferRowLength = 0;
+                    region.bufferImageHeight = 0;
+                    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+                    region.imageSubresource.mipLevel = level;
+                    region.imageSubresource.baseArrayLayer = 0;
+                    region.imageSubresource.layerCount = texture->layerCount;
+                    region.imageExtent = {std::max(texture->width >> level, 1u), std::max(texture->height >> level, 1u), 1};
+
+                    vkCmdCopyBufferToImage(commandBuffer, source, texture->image.get(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+                    levelBarrier(commandBuffer, texture, level, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                        VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+                    texture->residentLevel = level;
+                    uploaded++;
+                }
+
+                if(texture->residentLevel != previousResidentLevel) {
+                    VkDevice device = *pDevice->getLogicalDevicePtr();
+
+                    if(texture->view) {
+                        texture->retiredViews.emplace_back(updateCount, std::move(texture->view));
+                    }
+
+                    texture->view = ImageViewHandle(pDevice->CreateImageView(texture->image.get(), texture->format, VK_IMAGE_ASPECT_COLOR_BIT, texture->residentLevel,
+                        texture->levelCount - texture->residentLevel, 0, texture->layerCount, texture->viewType), {device});
+                    texture->viewVersion++;
+                }
+            }
+
+            return uploaded;
+        }
+    };
+
+    typedef Vg_TextureStreamer TextureStreamer;
+}
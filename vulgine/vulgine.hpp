@@ -6,4 +6,32 @@
 
 #ifndef VK_DEVICE
 #include "vg_devices.hpp"
+#endif
+
+#ifndef VG_DRAW_BATCH
+#include "vg_draw_batch.hpp"
+#endif
+
+#ifndef VG_COMPUTE
+#include "vg_compute.hpp"
+#endif
+
+#ifndef VG_HIZ
+#include "vg_hiz.hpp"
+#endif
+
+#ifndef VG_MESH
+#include "vg_mesh.hpp"
+#endif
+
+#ifndef VG_TEXTURE
+#include "vg_texture.hpp"
+#endif
+
+#ifndef VG_SUBMIT
+#include "vg_submit.hpp"
+#endif
+
+#ifndef VG_ECS
+#include "vg_ecs.hpp"
 #endif
\ No newline at end of file